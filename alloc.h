@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint> // Required for fixed-width integer types
+#include <cstddef> // Required for size_t
+#include <cstdlib> // Required for std::malloc/std::free (counting allocator)
+#include <new>     // Required for std::bad_alloc
+#include <array>   // Required for std::array (per-subsystem counters)
+#include <atomic>  // Required for std::atomic (counters shared by every thread)
+
+#include "platform.h" // DUNGEON_NOINLINE
+
+// =================================================================================
+// === Opt-in allocation tracking ==================================================
+// =================================================================================
+//
+// Counts heap allocations and bytes per subsystem. Code marks which subsystem it is working for with an AllocScope;
+// the innermost scope on the current thread gets the allocation, and anything outside a scope counts as game logic.
+// An AllocWindow turns the running totals into per-frame or per-turn numbers.
+//
+// Tracking is off unless the program defines DUNGEON_TRACK_ALLOCATIONS before including this header; this header then
+// replaces the global operator new and delete, so it must be included by exactly one translation unit (every
+// program of this repo is a single one). Without the define, scopes compile to nothing and every count stays 0.
+
+/**
+ * @brief The subsystems allocations are charged to.
+ */
+enum class AllocTag : uint8_t
+{
+    Logic,   // Game rules and the loop itself (the default).
+    Player,  // Player and its inventory.
+    Dungeon, // Dungeon, rooms and loot tables.
+    Gui,     // Status text, overlay and drawing.
+};
+
+const size_t allocTagCount = 4;
+
+/**
+ * @brief Gets a subsystem's display name, e.g. "player".
+ */
+inline const char *allocTagName(AllocTag tag)
+{
+    static const char *const names[allocTagCount] = {"logic", "player", "dungeon", "gui"};
+    return names[static_cast<size_t>(tag)];
+}
+
+/**
+ * @brief Allocations and bytes requested.
+ */
+struct AllocStats
+{
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief Allocation totals per subsystem at one moment, or the difference between two moments.
+ */
+struct AllocSnapshot
+{
+    std::array<AllocStats, allocTagCount> tags{};
+
+    const AllocStats &operator[](AllocTag tag) const { return tags[static_cast<size_t>(tag)]; }
+
+    /**
+     * @brief Gets the sum over every subsystem.
+     */
+    AllocStats total() const
+    {
+        AllocStats sum;
+        for (const AllocStats &stats : tags)
+        {
+            sum.count += stats.count;
+            sum.bytes += stats.bytes;
+        }
+        return sum;
+    }
+
+    AllocSnapshot operator-(const AllocSnapshot &earlier) const
+    {
+        AllocSnapshot difference;
+        for (size_t t = 0; t < allocTagCount; ++t)
+        {
+            difference.tags[t].count = tags[t].count - earlier.tags[t].count;
+            difference.tags[t].bytes = tags[t].bytes - earlier.tags[t].bytes;
+        }
+        return difference;
+    }
+};
+
+#ifdef DUNGEON_TRACK_ALLOCATIONS
+const bool allocTrackingEnabled = true;
+#else
+const bool allocTrackingEnabled = false;
+#endif
+
+// Running totals, shared by every thread; relaxed increments are enough for counters.
+inline std::array<std::atomic<uint64_t>, allocTagCount> allocCounts{};
+inline std::array<std::atomic<uint64_t>, allocTagCount> allocBytes{};
+
+// The subsystem the current thread is working for.
+inline thread_local AllocTag currentAllocTag = AllocTag::Logic;
+
+/**
+ * @brief Charges one allocation to the current thread's subsystem. Called by the replacement operator new.
+ * @param bytes The size requested.
+ */
+inline void recordAllocation(size_t bytes)
+{
+    const size_t tag = static_cast<size_t>(currentAllocTag);
+    allocCounts[tag].fetch_add(1, std::memory_order_relaxed);
+    allocBytes[tag].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reads the running totals of every subsystem.
+ */
+inline AllocSnapshot allocSnapshot()
+{
+    AllocSnapshot snapshot;
+    for (size_t t = 0; t < allocTagCount; ++t)
+    {
+        snapshot.tags[t].count = allocCounts[t].load(std::memory_order_relaxed);
+        snapshot.tags[t].bytes = allocBytes[t].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Charges the current thread's allocations to a subsystem until the scope ends (scopes nest).
+ */
+class AllocScope
+{
+#ifdef DUNGEON_TRACK_ALLOCATIONS
+private:
+    AllocTag previous;
+
+public:
+    explicit AllocScope(AllocTag tag) : previous(currentAllocTag) { currentAllocTag = tag; }
+    ~AllocScope() { currentAllocTag = previous; }
+#else
+public:
+    explicit AllocScope(AllocTag) {}
+#endif
+    AllocScope(const AllocScope &) = delete;
+    AllocScope &operator=(const AllocScope &) = delete;
+};
+
+/**
+ * @brief Measures the allocations of a repeating window, such as a frame or a turn: begin() and end() bracket one
+ * window, and getLast() keeps the numbers of the last completed one.
+ */
+class AllocWindow
+{
+private:
+    AllocSnapshot start;
+    AllocSnapshot last;
+    uint64_t windows = 0;
+
+public:
+    void begin() { start = allocSnapshot(); }
+
+    void end()
+    {
+        last = allocSnapshot() - start;
+        windows++;
+    }
+
+    /**
+     * @brief Gets the allocations of the last completed window.
+     */
+    const AllocSnapshot &getLast() const { return last; }
+
+    /**
+     * @brief Gets the number of completed windows.
+     */
+    uint64_t getWindows() const { return windows; }
+};
+
+#ifdef DUNGEON_TRACK_ALLOCATIONS
+// Replacement global allocation functions. The array forms forward to these by default.
+// The deletes are kept out of line: once inlined, GCC pairs their free() with its own idea of operator new and warns.
+void *operator new(std::size_t size)
+{
+    recordAllocation(size);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+DUNGEON_NOINLINE void operator delete(void *p) noexcept { std::free(p); }
+DUNGEON_NOINLINE void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#endif
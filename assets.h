@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>   // Required for size_t
+#include <vector>    // Required for std::vector container
+#include <memory>    // Required for smart pointers (std::unique_ptr)
+#include <utility>   // Required for std::move
+#include <stdexcept> // Required for std::out_of_range
+
+/**
+ * @brief A templated manager class for storing and retrieving game assets.
+ * Uses unique_ptr to manage memory for stored assets, ensuring proper deallocation.
+ * Lives in its own header (it needs no SFML) so the benchmarks can measure it outside the GUI game.
+ * @tparam T The type of asset to manage (e.g., Room, Enemy, etc.).
+ */
+template <typename T>
+class GameAssetManager
+{
+private:
+    std::vector<std::unique_ptr<T>> assets; // Stores assets using smart pointers (unique ownership).
+
+public:
+    /**
+     * @brief Adds a new asset to the manager.
+     * Takes ownership of the unique_ptr.
+     * @param asset A unique_ptr to the asset to add.
+     */
+    void addAsset(std::unique_ptr<T> asset)
+    {
+        assets.push_back(std::move(asset)); // Use std::move to transfer ownership of the unique_ptr.
+    }
+
+    /**
+     * @brief Reserves room for a number of assets, so adding that many grows the storage only once.
+     * @param count The number of assets the manager will hold.
+     */
+    void reserve(size_t count)
+    {
+        assets.reserve(count);
+    }
+
+    /**
+     * @brief Retrieves a constant pointer to an asset at a specific index.
+     * Throws an out_of_range exception if the index is invalid.
+     * @param index The index of the asset to retrieve.
+     * @return A constant pointer to the asset.
+     * @throws out_of_range If the index is outside the bounds of the assets vector.
+     */
+    const T *getAsset(size_t index) const
+    {
+        if (index < assets.size()) // Check if the index is within valid bounds.
+        {
+            return assets[index].get(); // Return the raw pointer managed by unique_ptr.
+        }
+        // Throw an exception for invalid access.
+        throw std::out_of_range("Asset index out of bounds.");
+    }
+
+    /**
+     * @brief Gets the total number of assets currently managed.
+     * @return The count of assets.
+     */
+    size_t getAssetCount() const
+    {
+        return assets.size();
+    }
+};
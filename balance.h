@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <array>     // Required for std::array (enemy health per room)
+#include <vector>    // Required for std::vector (targets, results)
+#include <string>    // Required for describeBalance
+#include <thread>    // Required for std::thread (parallel evaluation)
+#include <algorithm> // Required for std::min, std::max
+#include <utility>   // Required for std::move
+#include <stdexcept> // Required for std::invalid_argument
+
+#include "random.h"     // Rng, streamKey
+#include "campaign.h"   // RuleSet, builtinRules
+#include "simulation.h" // SimSession, simulateGame
+
+// Largest number of rooms whose enemies a tuner can adjust.
+const int maxTunedRooms = 8;
+
+/**
+ * @brief One setting of every balance constant: the enemies' health per room plus the rules.
+ */
+struct BalanceParams
+{
+    std::array<int, maxTunedRooms> enemyHealth{}; // Strength (and damage) of each room's enemy.
+    int roomCount = 0;                            // Rooms in use.
+    RuleSet rules = builtinRules;
+};
+
+/**
+ * @brief Reads a dungeon's current balance constants.
+ * @tparam Rooms The dungeon's room interface (see simulateTurn).
+ * @param dungeon The dungeon.
+ * @return Its enemies' health and rules.
+ * @throws invalid_argument If the dungeon has more than maxTunedRooms rooms.
+ */
+template <typename Rooms>
+BalanceParams currentBalance(const Rooms &dungeon)
+{
+    if (dungeon.roomCount() > maxTunedRooms)
+        throw std::invalid_argument("Dungeon has too many rooms to tune.");
+    BalanceParams params;
+    params.roomCount = dungeon.roomCount();
+    for (int room = 0; room < params.roomCount; ++room)
+        params.enemyHealth[room] = dungeon.enemyStats(room).health;
+    params.rules = dungeon.rules();
+    return params;
+}
+
+/**
+ * @brief Writes balance constants as one line, e.g. "enemies 15/25/35/50/70, flee 10, bypass 5, ...".
+ */
+inline std::string describeBalance(const BalanceParams &params)
+{
+    std::string text = "enemies ";
+    for (int room = 0; room < params.roomCount; ++room)
+        text += (room ? "/" : "") + std::to_string(params.enemyHealth[room]);
+    text += ", flee " + std::to_string(params.rules.fleeDamage) + ", bypass " + std::to_string(params.rules.bypassDamage) +
+            ", coins " + std::to_string(params.rules.winCoins) + ", start moves " + std::to_string(params.rules.startMoves) +
+            ", lose below " + std::to_string(params.rules.minHealth);
+    return text;
+}
+
+/**
+ * @brief A dungeon with other balance constants: the base dungeon's rooms and loot, with its own enemy health and rules.
+ * The base dungeon (and its loot tables) is shared, not copied, so a candidate costs nothing to set up and any number
+ * of threads can play it at once.
+ * @tparam Base The shared dungeon's room interface.
+ */
+template <typename Base>
+class TunedRooms
+{
+private:
+    const Base *base;
+    BalanceParams params;
+
+public:
+    /**
+     * @brief Constructor for the TunedRooms class.
+     * @param dungeon The shared dungeon; must outlive this object.
+     * @param balance The constants to play with; roomCount must not exceed the dungeon's.
+     */
+    TunedRooms(const Base &dungeon, const BalanceParams &balance) : base(&dungeon), params(balance) {}
+
+    // The room interface used by simulateTurn().
+    int roomCount() const { return params.roomCount; }
+    CombatStats enemyStats(int room) const { return {params.enemyHealth[room], params.enemyHealth[room], 0}; }
+    ItemId rollLoot(int room, Rng &rng) const { return base->rollLoot(room, rng); }
+    std::vector<LootOdds> lootOdds(int room) const { return base->lootOdds(room); }
+    const RuleSet &rules() const { return params.rules; }
+};
+
+/**
+ * @brief A simple reference player: fights while its health is at least a threshold, otherwise sneaks past.
+ * A low threshold plays recklessly, a high one carefully.
+ */
+struct ThresholdPolicy
+{
+    int fightAbove = 50;
+
+    template <typename Rooms>
+    SimAction operator()(const SimSession &session, const Rooms &) const
+    {
+        return session.player.getHealth() >= fightAbove ? SimAction::Fight : SimAction::Bypass;
+    }
+};
+
+/**
+ * @brief A win rate the game should give a reference player.
+ * @tparam Policy The reference player (a simulateGame() policy; copied once per thread).
+ */
+template <typename Policy>
+struct BalanceTarget
+{
+    Policy policy;
+    double escapeRate; // Desired fraction of games won.
+};
+
+/**
+ * @brief Settings of a balance search.
+ */
+struct BalanceConfig
+{
+    uint64_t games = 20000;   // Games per target and candidate.
+    unsigned threads = 0;     // Worker threads; 0 uses every hardware thread.
+    uint64_t seed = 1;        // Every candidate plays the same games (common random numbers), so comparisons are fair.
+    int initialStep = 8;      // First step of the coordinate search; halved whenever no step helps.
+    int maxEvaluations = 400; // Budget of the coordinate search.
+    double tolerance = 1e-4;  // Stop once the error is this small.
+};
+
+/**
+ * @brief A scored candidate.
+ */
+struct BalanceResult
+{
+    BalanceParams params;
+    std::vector<double> escapeRates; // Measured win rate per target.
+    double error = 0.0;              // Sum of squared differences from the targets.
+};
+
+/**
+ * @brief Searches the balance constants for values that give the target win rates, using the headless engine.
+ * Each candidate is evaluated by playing config.games games per target, spread over worker threads that all share
+ * the base dungeon through TunedRooms; nothing is rebuilt between candidates.
+ * The coordinate search adjusts one constant at a time (enemy health per room, flee and bypass damage, starting
+ * moves and the losing threshold), keeping any step that lowers the error. Coins are never adjusted, because no
+ * outcome depends on them; sweep() can still try them.
+ * @tparam Base The shared dungeon's room interface.
+ * @tparam Policy The reference players' type.
+ * @tparam Variant The rules the games are played by (GuiRules or ConsoleRules), from its opening position.
+ */
+template <typename Base, typename Policy = ThresholdPolicy, typename Variant = GuiRules>
+class BalanceTuner
+{
+private:
+    const Base *base;
+    std::vector<BalanceTarget<Policy>> targets;
+    BalanceConfig config;
+    uint64_t evaluations = 0;
+
+    // The constants the coordinate search adjusts, with their allowed ranges.
+    static int knobCount(const BalanceParams &params) { return params.roomCount + 4; }
+
+    static int &knob(BalanceParams &params, int k)
+    {
+        if (k < params.roomCount)
+            return params.enemyHealth[k];
+        switch (k - params.roomCount)
+        {
+        case 0:
+            return params.rules.fleeDamage;
+        case 1:
+            return params.rules.bypassDamage;
+        case 2:
+            return params.rules.startMoves;
+        default:
+            return params.rules.minHealth;
+        }
+    }
+
+    static int knobMin(const BalanceParams &params, int k)
+    {
+        const int rule = k - params.roomCount;
+        return rule == 0 || rule == 1 ? 0 : 1; // Damage may be 0; health, moves and the threshold may not.
+    }
+
+    static int knobMax(const BalanceParams &params, int k) { return k - params.roomCount == 3 ? 99 : 250; }
+
+public:
+    /**
+     * @brief Constructor for the BalanceTuner class.
+     * @param dungeon The shared dungeon; must outlive the tuner.
+     * @param goals The win rates to aim for; at least one.
+     * @param settings Search settings.
+     * @throws invalid_argument If there are no targets.
+     */
+    BalanceTuner(const Base &dungeon, std::vector<BalanceTarget<Policy>> goals, BalanceConfig settings = {})
+        : base(&dungeon), targets(std::move(goals)), config(settings)
+    {
+        if (targets.empty())
+            throw std::invalid_argument("Balance tuner needs at least one target.");
+        if (config.threads == 0)
+            config.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Plays every target's games with one candidate and scores it.
+     * @param params The candidate.
+     * @return The win rates and error.
+     */
+    BalanceResult evaluate(const BalanceParams &params)
+    {
+        const TunedRooms<Base> dungeon(*base, params);
+        const unsigned threadCount = config.threads;
+        std::vector<uint64_t> escapes(threadCount * targets.size(), 0);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (size_t target = 0; target < targets.size(); ++target)
+                {
+                    Policy policy = targets[target].policy;
+                    uint64_t &count = escapes[t * targets.size() + target];
+                    for (uint64_t game = t; game < config.games; game += threadCount)
+                    {
+                        SimSession session = startSession<Variant>(Rng(streamKey(config.seed, game)), params.rules.startMoves);
+                        if (simulateGame<Variant>(session, dungeon, policy) == SimStatus::Escaped)
+                            count++;
+                    }
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+
+        BalanceResult result{params, std::vector<double>(targets.size(), 0.0), 0.0};
+        for (size_t target = 0; target < targets.size(); ++target)
+        {
+            uint64_t total = 0;
+            for (unsigned t = 0; t < threadCount; ++t)
+                total += escapes[t * targets.size() + target];
+            result.escapeRates[target] = config.games ? static_cast<double>(total) / static_cast<double>(config.games) : 0.0;
+            const double miss = result.escapeRates[target] - targets[target].escapeRate;
+            result.error += miss * miss;
+        }
+        evaluations++;
+        return result;
+    }
+
+    /**
+     * @brief Evaluates a list of candidates (e.g. a grid), in order.
+     * @param candidates The candidates.
+     * @return One result per candidate.
+     */
+    std::vector<BalanceResult> sweep(const std::vector<BalanceParams> &candidates)
+    {
+        std::vector<BalanceResult> results;
+        for (const BalanceParams &params : candidates)
+            results.push_back(evaluate(params));
+        return results;
+    }
+
+    /**
+     * @brief Coordinate search from a starting point: tries each constant one step up and down, keeps the first
+     * improvement, and halves the step when none helps, until the step drops below 1, the error is within
+     * tolerance or the evaluation budget is spent.
+     * @param start Where to start (usually currentBalance() of the dungeon).
+     * @return The best candidate found.
+     */
+    BalanceResult optimize(const BalanceParams &start)
+    {
+        const uint64_t budgetEnd = evaluations + static_cast<uint64_t>(std::max(config.maxEvaluations, 1));
+        BalanceResult best = evaluate(start);
+        int step = std::max(config.initialStep, 1);
+        while (step >= 1 && best.error > config.tolerance && evaluations < budgetEnd)
+        {
+            bool improved = false;
+            for (int k = 0; k < knobCount(best.params) && !improved && evaluations < budgetEnd; ++k)
+            {
+                for (int direction : {1, -1})
+                {
+                    BalanceParams candidate = best.params;
+                    int &value = knob(candidate, k);
+                    const int moved = std::min(knobMax(candidate, k), std::max(knobMin(candidate, k), value + direction * step));
+                    if (moved == value)
+                        continue;
+                    value = moved;
+                    BalanceResult result = evaluate(candidate);
+                    if (result.error < best.error)
+                    {
+                        best = std::move(result);
+                        improved = true;
+                        break;
+                    }
+                    if (evaluations >= budgetEnd)
+                        break;
+                }
+            }
+            if (!improved)
+                step /= 2;
+        }
+        return best;
+    }
+
+    /**
+     * @brief Gets the number of candidates evaluated so far.
+     */
+    uint64_t getEvaluations() const { return evaluations; }
+};
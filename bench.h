@@ -0,0 +1,504 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <cstdio>    // Required for std::snprintf (JSON numbers)
+#include <cstdlib>   // Required for std::strtod (baseline numbers)
+#include <cstring>   // Required for std::strlen (command-line options)
+#include <chrono>    // Required for timing with steady_clock
+#include <ctime>     // Required for the run's date in the JSON context
+#include <string>    // Required for benchmark names
+#include <vector>    // Required for std::vector (registry, argument lists)
+#include <memory>    // Required for std::unique_ptr (registered benchmarks)
+#include <map>       // Required for std::map (baseline results by name)
+#include <thread>    // Required for std::thread::hardware_concurrency
+#include <fstream>   // Required for reading and writing JSON results
+#include <sstream>   // Required for reading a whole baseline file
+#include <iostream>  // Required for output of results
+#include <iomanip>   // Required for setw/setprecision formatting
+#include <algorithm> // Required for std::min, std::max
+#include <utility>   // Required for std::move
+#include <stdexcept> // Required for std::invalid_argument, std::runtime_error
+
+#include "alloc.h"    // Allocation counts per subsystem
+#include "platform.h" // DUNGEON_UNUSED
+
+// =================================================================================
+// === A small Google Benchmark-style harness ======================================
+// =================================================================================
+//
+// Benchmarks are functions taking a BenchState& and looping `for (auto _ : state)` over the measured work; the
+// harness picks the iteration count, so each one runs for at least --min-time seconds:
+//
+//     void benchAddToInventory(BenchState &state)
+//     {
+//         Player player("Bench");
+//         for (auto _ : state)
+//             player.addToInventory("Armour");
+//     }
+//     BENCHMARK(benchAddToInventory)->range(8, 512);
+//
+// runBenchmarks() prints time and heap allocations per iteration, can save the results as JSON (in the layout
+// Google Benchmark writes, plus the allocation fields) and can compare a run against saved results. Allocations are
+// only counted in programs built with DUNGEON_TRACK_ALLOCATIONS (see alloc.h); they are split by subsystem.
+
+/**
+ * @brief Keeps a value alive so the optimizer cannot remove the work that produced it.
+ */
+template <typename T>
+inline void benchDoNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief The state of one benchmark run: its arguments, the iteration loop and its timer.
+ */
+class BenchState
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<int64_t> args;
+    uint64_t maxIterations;
+    uint64_t itemsProcessed = 0;
+    Clock::time_point started;
+    double elapsed = 0.0;      // Seconds measured so far.
+    AllocSnapshot allocStart;  // Totals when the timer last started.
+    AllocSnapshot allocations; // Allocations measured so far, per subsystem.
+
+    void startTimer()
+    {
+        allocStart = allocSnapshot();
+        started = Clock::now();
+    }
+
+    void stopTimer()
+    {
+        elapsed += std::chrono::duration<double>(Clock::now() - started).count();
+        const AllocSnapshot measured = allocSnapshot() - allocStart;
+        for (size_t t = 0; t < allocTagCount; ++t)
+        {
+            allocations.tags[t].count += measured.tags[t].count;
+            allocations.tags[t].bytes += measured.tags[t].bytes;
+        }
+    }
+
+public:
+    // The iteration loop: `for (auto _ : state)` runs maxIterations times between starting and stopping the timer.
+    struct Iterator
+    {
+        BenchState *state;
+        uint64_t left;
+
+        struct DUNGEON_UNUSED Value // `auto _` is never read.
+        {
+        };
+
+        Value operator*() const { return {}; }
+        Iterator &operator++()
+        {
+            --left;
+            return *this;
+        }
+        bool operator!=(const Iterator &) const
+        {
+            if (left > 0)
+                return true;
+            state->stopTimer();
+            return false;
+        }
+    };
+
+    /**
+     * @brief Constructor for the BenchState class.
+     * @param arguments The benchmark's arguments (from arg() or range()).
+     * @param iterations How many times the loop runs.
+     */
+    BenchState(std::vector<int64_t> arguments, uint64_t iterations) : args(std::move(arguments)), maxIterations(iterations) {}
+
+    Iterator begin()
+    {
+        startTimer();
+        return {this, maxIterations};
+    }
+    Iterator end() { return {this, 0}; }
+
+    /**
+     * @brief Gets one of the benchmark's arguments, e.g. the size of the data set.
+     * @param index Which argument.
+     * @return The argument, or 0 if there is none.
+     */
+    int64_t range(size_t index = 0) const { return index < args.size() ? args[index] : 0; }
+
+    /**
+     * @brief Gets the number of iterations of this run.
+     */
+    uint64_t iterations() const { return maxIterations; }
+
+    /**
+     * @brief Stops the timer (and the allocation count) for setup inside the loop; resumeTiming() restarts it.
+     */
+    void pauseTiming() { stopTimer(); }
+    void resumeTiming() { startTimer(); }
+
+    /**
+     * @brief Sets how many items the whole run processed, to report a rate (e.g. items added per second).
+     */
+    void setItemsProcessed(uint64_t items) { itemsProcessed = items; }
+
+    // Results of the run.
+    double seconds() const { return elapsed; }
+    const AllocSnapshot &allocationStats() const { return allocations; }
+    uint64_t items() const { return itemsProcessed; }
+};
+
+/**
+ * @brief A registered benchmark with the argument sets it runs with.
+ */
+class BenchCase
+{
+private:
+    std::string name;
+    void (*function)(BenchState &);
+    std::vector<std::vector<int64_t>> argSets;
+    uint64_t fixedIterations = 0;              // 0 lets the harness calibrate the count.
+    int64_t allocationLimit = -1;              // Most allocations a run may make; -1 for no limit.
+
+public:
+    /**
+     * @brief Constructor for the BenchCase class.
+     * @param caseName The name printed and saved for this benchmark.
+     * @param fn The benchmark function.
+     */
+    BenchCase(std::string caseName, void (*fn)(BenchState &)) : name(std::move(caseName)), function(fn) {}
+
+    /**
+     * @brief Adds a run with one argument.
+     */
+    BenchCase *arg(int64_t value)
+    {
+        argSets.push_back({value});
+        return this;
+    }
+
+    /**
+     * @brief Adds runs with lo, every power of `multiplier` between lo and hi, and hi (like Google Benchmark's Range).
+     */
+    BenchCase *range(int64_t lo, int64_t hi, int64_t multiplier = 8)
+    {
+        arg(lo);
+        int64_t value = 1;
+        while (value <= lo)
+            value *= multiplier;
+        for (; value < hi; value *= multiplier)
+            arg(value);
+        if (hi > lo)
+            arg(hi);
+        return this;
+    }
+
+    /**
+     * @brief Runs exactly this many iterations instead of calibrating to --min-time.
+     */
+    BenchCase *iterations(uint64_t count)
+    {
+        fixedIterations = count;
+        return this;
+    }
+
+    /**
+     * @brief Makes the suite fail if a run allocates more than this many times in total (0 for allocation-free
+     * code). Only meaningful in programs built with DUNGEON_TRACK_ALLOCATIONS.
+     */
+    BenchCase *maxAllocations(uint64_t limit)
+    {
+        allocationLimit = static_cast<int64_t>(limit);
+        return this;
+    }
+
+    const std::string &getName() const { return name; }
+    uint64_t getFixedIterations() const { return fixedIterations; }
+    int64_t getAllocationLimit() const { return allocationLimit; }
+    void (*getFunction() const)(BenchState &) { return function; }
+
+    /**
+     * @brief Gets the argument sets to run with; a single empty one if none were added.
+     */
+    std::vector<std::vector<int64_t>> getArgSets() const
+    {
+        return argSets.empty() ? std::vector<std::vector<int64_t>>{{}} : argSets;
+    }
+};
+
+/**
+ * @brief Gets every registered benchmark, in registration order.
+ */
+inline std::vector<std::unique_ptr<BenchCase>> &benchRegistry()
+{
+    static std::vector<std::unique_ptr<BenchCase>> registry;
+    return registry;
+}
+
+/**
+ * @brief Registers a benchmark; use the BENCHMARK macro instead.
+ */
+inline BenchCase *registerBenchmark(const char *name, void (*fn)(BenchState &))
+{
+    benchRegistry().push_back(std::make_unique<BenchCase>(name, fn));
+    return benchRegistry().back().get();
+}
+
+#define BENCH_CONCAT_INNER(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_INNER(a, b)
+#define BENCHMARK(fn) static BenchCase *BENCH_CONCAT(benchCase_, __LINE__) = registerBenchmark(#fn, fn)
+
+/**
+ * @brief One measured benchmark, as printed and saved.
+ */
+struct BenchResult
+{
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerIteration = 0.0;
+    double allocsPerIteration = 0.0;
+    double bytesPerIteration = 0.0;
+    std::array<double, allocTagCount> allocsByTag{}; // Allocations per iteration charged to each subsystem.
+    double itemsPerSecond = 0.0; // 0 if the benchmark does not report items.
+    uint64_t allocations = 0;    // Allocations of the whole run.
+    bool failed = false;         // True if the run broke its allocation limit.
+};
+
+/**
+ * @brief Command-line settings of runBenchmarks().
+ */
+struct BenchOptions
+{
+    std::string filter;   // Only run benchmarks whose name contains this.
+    double minTime = 0.5; // Seconds each benchmark runs for at least.
+    std::string jsonPath; // Save the results here.
+    std::string baseline; // Compare against results saved by an earlier run.
+};
+
+/**
+ * @brief Writes results in Google Benchmark's JSON layout, with allocs_per_iter, bytes_per_iter and
+ * allocs_by_subsystem added to each benchmark.
+ */
+inline void writeBenchJson(const std::string &path, const std::vector<BenchResult> &results)
+{
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot write " + path);
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"num_cpus\": " << std::thread::hardware_concurrency()
+        << "\n  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        char numbers[512];
+        int length = std::snprintf(numbers, sizeof(numbers),
+                                   "\"iterations\": %llu, \"real_time\": %.3f, \"time_unit\": \"ns\", \"allocs_per_iter\": %.3f, "
+                                   "\"bytes_per_iter\": %.1f, \"items_per_second\": %.1f, \"allocs_by_subsystem\": {",
+                                   static_cast<unsigned long long>(r.iterations), r.nsPerIteration, r.allocsPerIteration,
+                                   r.bytesPerIteration, r.itemsPerSecond);
+        for (size_t t = 0; t < allocTagCount; ++t)
+            length += std::snprintf(numbers + length, sizeof(numbers) - length, "%s\"%s\": %.3f", t ? ", " : "",
+                                    allocTagName(static_cast<AllocTag>(t)), r.allocsByTag[t]);
+        out << "    {\"name\": \"" << r.name << "\", " << numbers << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * @brief Reads results saved by writeBenchJson() (or by Google Benchmark: allocations then read as 0).
+ * Only the fields it needs are parsed, so hand-edited files work as long as every benchmark object starts with
+ * its name.
+ * @return Results by name.
+ */
+inline std::map<std::string, BenchResult> readBenchJson(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot read " + path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    // Number after "key": inside [from, to), or 0 if absent.
+    auto number = [&](const char *key, size_t from, size_t to) {
+        const size_t at = text.find(std::string("\"") + key + "\":", from);
+        return at < to ? std::strtod(text.c_str() + at + std::strlen(key) + 3, nullptr) : 0.0;
+    };
+
+    std::map<std::string, BenchResult> results;
+    size_t at = text.find("\"benchmarks\"");
+    while (at != std::string::npos && (at = text.find("\"name\":", at)) != std::string::npos)
+    {
+        const size_t open = text.find('"', at + 7);
+        const size_t close = text.find('"', open + 1);
+        if (open == std::string::npos || close == std::string::npos)
+            break;
+        const size_t next = text.find("\"name\":", close);
+        BenchResult r;
+        r.name = text.substr(open + 1, close - open - 1);
+        r.iterations = static_cast<uint64_t>(number("iterations", close, next));
+        r.nsPerIteration = number("real_time", close, next);
+        r.allocsPerIteration = number("allocs_per_iter", close, next);
+        r.bytesPerIteration = number("bytes_per_iter", close, next);
+        r.itemsPerSecond = number("items_per_second", close, next);
+        results[r.name] = r;
+        at = close;
+    }
+    return results;
+}
+
+/**
+ * @brief Parses --filter=, --min-time=, --json= and --baseline=.
+ * @throws invalid_argument On an unknown option.
+ */
+inline BenchOptions parseBenchOptions(int argc, char *argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        auto value = [&](const char *prefix) { return option.substr(std::strlen(prefix)); };
+        if (option.rfind("--filter=", 0) == 0)
+            options.filter = value("--filter=");
+        else if (option.rfind("--min-time=", 0) == 0)
+            options.minTime = std::stod(value("--min-time="));
+        else if (option.rfind("--json=", 0) == 0)
+            options.jsonPath = value("--json=");
+        else if (option.rfind("--baseline=", 0) == 0)
+            options.baseline = value("--baseline=");
+        else
+            throw std::invalid_argument("Unknown option " + option +
+                                        " (use --filter=NAME, --min-time=SECONDS, --json=FILE, --baseline=FILE)");
+    }
+    return options;
+}
+
+/**
+ * @brief Runs one benchmark with one argument set, growing the iteration count until a run lasts minTime.
+ */
+inline BenchResult runBenchCase(const BenchCase &bench, const std::vector<int64_t> &args, double minTime)
+{
+    BenchResult result;
+    result.name = bench.getName();
+    for (int64_t a : args)
+        result.name += "/" + std::to_string(a);
+
+    uint64_t iterations = bench.getFixedIterations() ? bench.getFixedIterations() : 1;
+    while (true)
+    {
+        BenchState state(args, iterations);
+        bench.getFunction()(state);
+        const double seconds = state.seconds();
+        if (bench.getFixedIterations() || seconds >= minTime || iterations >= 1000000000ull)
+        {
+            result.iterations = iterations;
+            result.nsPerIteration = seconds * 1e9 / static_cast<double>(iterations);
+            const AllocSnapshot &allocations = state.allocationStats();
+            result.allocsPerIteration = static_cast<double>(allocations.total().count) / static_cast<double>(iterations);
+            result.bytesPerIteration = static_cast<double>(allocations.total().bytes) / static_cast<double>(iterations);
+            for (size_t t = 0; t < allocTagCount; ++t)
+                result.allocsByTag[t] = static_cast<double>(allocations.tags[t].count) / static_cast<double>(iterations);
+            result.itemsPerSecond = state.items() && seconds > 0.0 ? static_cast<double>(state.items()) / seconds : 0.0;
+            result.allocations = allocations.total().count;
+            result.failed = bench.getAllocationLimit() >= 0 && result.allocations > static_cast<uint64_t>(bench.getAllocationLimit());
+            return result;
+        }
+        // Aim 40% past the target from the last run's rate, growing at most 10x at a time (like Google Benchmark).
+        const double scale = seconds > 0.0 ? std::min(10.0, std::max(1.0, minTime * 1.4 / seconds)) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(static_cast<double>(iterations) * scale));
+    }
+}
+
+/**
+ * @brief Runs every registered benchmark matching the options and prints a table; the entry point of a suite.
+ * @return 0, or 1 if the options or files were bad or a benchmark broke its allocation limit.
+ */
+inline int runBenchmarks(int argc, char *argv[])
+{
+    BenchOptions options;
+    std::map<std::string, BenchResult> baseline;
+    try
+    {
+        options = parseBenchOptions(argc, argv);
+        if (!options.baseline.empty())
+            baseline = readBenchJson(options.baseline);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(14) << "Time" << std::setw(13)
+              << "Iterations" << std::setw(13) << "Allocs/iter" << std::setw(12) << "Bytes/iter" << std::setw(16)
+              << "Items/s" << (baseline.empty() ? "" : "   vs baseline") << "   Allocs by subsystem\n"
+              << std::string(baseline.empty() ? 128 : 160, '-') << "\n";
+
+    std::vector<BenchResult> results;
+    int failures = 0;
+    for (const std::unique_ptr<BenchCase> &bench : benchRegistry())
+    {
+        if (bench->getName().find(options.filter) == std::string::npos)
+            continue;
+        for (const std::vector<int64_t> &args : bench->getArgSets())
+        {
+            const BenchResult r = runBenchCase(*bench, args, options.minTime);
+            results.push_back(r);
+            std::cout << std::left << std::setw(36) << r.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(11) << r.nsPerIteration << " ns" << std::setw(13) << r.iterations << std::setprecision(2)
+                      << std::setw(13) << r.allocsPerIteration << std::setprecision(0) << std::setw(12) << r.bytesPerIteration
+                      << std::setw(16);
+            if (r.itemsPerSecond > 0.0)
+                std::cout << r.itemsPerSecond;
+            else
+                std::cout << "-";
+            auto old = baseline.find(r.name);
+            if (old != baseline.end() && old->second.nsPerIteration > 0.0)
+                std::cout << std::showpos << std::setprecision(1) << std::setw(10)
+                          << 100.0 * (r.nsPerIteration / old->second.nsPerIteration - 1.0) << "% time" << std::noshowpos
+                          << std::setprecision(2) << "  allocs " << old->second.allocsPerIteration << " -> "
+                          << r.allocsPerIteration;
+            else if (!baseline.empty())
+                std::cout << "   (new)";
+            const char *separator = "   ";
+            for (size_t t = 0; t < allocTagCount; ++t)
+            {
+                if (r.allocsByTag[t] == 0.0)
+                    continue;
+                std::cout << separator << allocTagName(static_cast<AllocTag>(t)) << " " << std::setprecision(2) << r.allocsByTag[t];
+                separator = ", ";
+            }
+            std::cout << "\n";
+            if (r.failed)
+            {
+                std::cout << "  FAILED: " << r.allocations << " allocations in " << r.iterations << " iterations (limit "
+                          << bench->getAllocationLimit() << ")\n";
+                failures++;
+            }
+        }
+    }
+
+    if (!options.jsonPath.empty())
+    {
+        try
+        {
+            writeBenchJson(options.jsonPath, results);
+            std::cout << "\nSaved " << results.size() << " results to " << options.jsonPath << "\n";
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (failures)
+        std::cout << "\n" << failures << " benchmark(s) broke their allocation limit.\n";
+    return failures ? 1 : 0;
+}
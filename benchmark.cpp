@@ -0,0 +1,684 @@
+#include <iostream> // Required for output of results
+#include <iomanip>  // Required for setw/setprecision formatting
+#include <chrono>   // Required for timing with steady_clock
+#include <random>   // Required for std::mt19937_64 (reference generator)
+#include <string>   // Required for benchmark names
+#include <cstdint>  // Required for fixed-width integer types
+#include <vector>   // Required for std::vector (benchmark data sets)
+#include <thread>   // Required for std::thread (shared-table benchmark)
+#include <algorithm> // Required for std::min, std::max
+#include <map>      // Required for std::multimap (timer baseline)
+#include <cmath>    // Required for std::sqrt, std::fabs (sampling tolerance)
+
+#include "random.h" // Seeded PRNG subsystem
+#include "combat.h" // Dice-based combat model
+#include "effects.h" // Item effect engine
+#include "items.h"  // Item registry and inventory stacks
+#include "loot.h"   // Alias-method loot tables
+#include "ecs.h"    // Entity-component storage
+#include "campaign.h" // Compile-time campaign tables
+#include "simulation.h" // Headless rules engine
+#include "gamestate.h" // Bit-packed game state
+#include "zobrist.h" // Zobrist state hashes
+#include "transposition.h" // Lock-free transposition table
+#include "mcts.h" // Monte Carlo tree search bot
+#include "env.h" // Vectorized training environment
+#include "markov.h" // Absorbing Markov chain analyzer
+#include "balance.h" // Parallel balance tuner
+#include "timedinput.h" // Multiplexed input with deadlines
+#include "timerwheel.h" // Hierarchical timer wheel
+
+using namespace std;
+
+// Results are folded into this sink so the optimizer cannot remove the measured work.
+static volatile uint64_t benchmarkSink = 0;
+
+/**
+ * @brief Runs a benchmark body a fixed number of times and prints the time per operation.
+ * @tparam Fn A callable taking the iteration index and returning a value to keep alive.
+ * @param name The name printed for this benchmark.
+ * @param iterations How many times to call the body.
+ * @param body The operation to measure.
+ * @param itemsPerCall How many operations one call performs (e.g. the size of a batch).
+ */
+template <typename Fn>
+void runBenchmark(const string &name, uint64_t iterations, Fn &&body, uint64_t itemsPerCall = 1)
+{
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < iterations / 10; ++i) // Warm-up pass (caches, branch predictors).
+        acc += static_cast<uint64_t>(body(i));
+
+    auto start = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+        acc += static_cast<uint64_t>(body(i));
+    auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    benchmarkSink = benchmarkSink + acc;
+
+    double nsPerOp = elapsed / static_cast<double>(iterations * itemsPerCall);
+    cout << left << setw(40) << name << right << fixed << setprecision(2) << setw(10) << nsPerOp << " ns/op"
+         << setw(14) << setprecision(1) << (1e3 / nsPerOp) << " M ops/s\n";
+}
+
+// =================================================================================
+// === Random number generation ====================================================
+// =================================================================================
+void benchmarkRandom()
+{
+    const uint64_t n = 50000000;
+
+    Rng rng(42);
+    runBenchmark("Rng::next", n, [&](uint64_t) { return rng.next(); });
+    runBenchmark("Rng::nextBelow(6)", n, [&](uint64_t) { return rng.nextBelow(6); });
+    runBenchmark("Rng::rollDice(2, 6)", n, [&](uint64_t) { return rng.rollDice(2, 6); });
+    runBenchmark("Rng::nextDouble", n, [&](uint64_t) { return static_cast<uint64_t>(rng.nextDouble() * 1000.0); });
+
+    const uint64_t key = streamKey(42, 7);
+    runBenchmark("counterRandom", n, [&](uint64_t i) { return counterRandom(key, i); });
+
+    mt19937_64 reference(42);
+    runBenchmark("std::mt19937_64 (reference)", n, [&](uint64_t) { return reference(); });
+
+    RngStreams streams(42);
+    runBenchmark("RngStreams::next (jump)", 200000, [&](uint64_t) { return streams.next().next(); });
+}
+
+// =================================================================================
+// === Combat resolution ===========================================================
+// =================================================================================
+void benchmarkCombat()
+{
+    const size_t fights = 4096;
+    const uint64_t rounds = 5000;
+
+    // Random player/enemy pairs around the built-in campaign's numbers.
+    Rng setup(7);
+    vector<CombatStats> players(fights), enemies(fights);
+    CombatBatch batch;
+    batch.resize(fights);
+    for (size_t i = 0; i < fights; ++i)
+    {
+        players[i] = {setup.nextInt(20, 100), 0, setup.nextInt(0, 10)};
+        int enemyHealth = setup.nextInt(15, 70);
+        enemies[i] = {enemyHealth, enemyHealth, 0};
+        batch.playerHealth[i] = players[i].health;
+        batch.playerAttack[i] = players[i].attack;
+        batch.playerDefense[i] = players[i].defense;
+        batch.enemyHealth[i] = enemies[i].health;
+        batch.enemyAttack[i] = enemies[i].attack;
+        batch.enemyDefense[i] = enemies[i].defense;
+    }
+
+    Rng rng(42);
+    vector<CombatResult> results(fights);
+    runBenchmark("resolveCombat (scalar, per fight)", rounds, [&](uint64_t) {
+        uint64_t wins = 0;
+        for (size_t i = 0; i < fights; ++i)
+        {
+            results[i] = resolveCombat(players[i], enemies[i], rng);
+            wins += results[i].playerWon;
+        }
+        return wins; }, fights);
+
+    runBenchmark("resolveCombatBatch (SoA, per fight)", rounds, [&](uint64_t round) {
+        resolveCombatBatch(batch, 42, round);
+        return batch.playerWon[round % fights]; }, fights);
+}
+
+// =================================================================================
+// === Loot drops ==================================================================
+// =================================================================================
+void benchmarkLoot()
+{
+    const uint64_t n = 20000000;
+    Rng rng(42);
+
+    for (size_t outcomes : {4, 64, 4096})
+    {
+        vector<double> weights(outcomes);
+        for (size_t i = 0; i < outcomes; ++i)
+            weights[i] = 1.0 + static_cast<double>(i % 7);
+
+        AliasTable table(weights);
+        runBenchmark("AliasTable::sample (" + to_string(outcomes) + " drops)", n, [&](uint64_t) { return table.sample(rng); });
+
+        discrete_distribution<uint32_t> reference(weights.begin(), weights.end());
+        runBenchmark("std::discrete_distribution (" + to_string(outcomes) + ")", n / 10, [&](uint64_t) { return reference(rng); });
+    }
+
+    runBenchmark("AliasTable build (4096 drops)", 2000, [&](uint64_t i) {
+        vector<double> weights(4096, 1.0 + static_cast<double>(i % 3));
+        return AliasTable(weights).size(); });
+}
+
+// =================================================================================
+// === Inventory ===================================================================
+// =================================================================================
+void benchmarkInventory()
+{
+    const uint64_t n = 50000000;
+    const ItemId armour = itemRegistry().find("Armour");
+    const ItemId potion = itemRegistry().find("Health Booster Potion");
+
+    Inventory inventory;
+    runBenchmark("Inventory::add", n, [&](uint64_t i) {
+        inventory.add(i & 1 ? armour : potion);
+        return inventory.mask(); });
+    runBenchmark("Inventory::remove", n, [&](uint64_t i) { return inventory.remove(i & 1 ? armour : potion); });
+    cout << "  sizeof(Inventory) = " << sizeof(Inventory) << " bytes, whatever the number of pickups\n";
+}
+
+// =================================================================================
+// === Item effects ================================================================
+// =================================================================================
+void benchmarkEffects()
+{
+    const size_t players = 4096;
+    const uint64_t rounds = 2000;
+    const Effect effects[] = {{EffectKind::Heal, 25}, {EffectKind::DamageReduction, 3}, {EffectKind::ExtraMoves, 2}};
+
+    EffectBatch batch;
+    batch.health.assign(players, 50);
+    batch.defense.assign(players, 0);
+    batch.moves.assign(players, 10);
+    runBenchmark("applyEffectsBatch (per effect)", rounds, [&](uint64_t round) {
+        for (uint32_t p = 0; p < players; ++p)
+            batch.push(p, effects[(p + round) % 3]);
+        applyEffectsBatch(batch);
+        return batch.health[round % players]; }, players);
+
+    EffectStats stats{50, 0, 10};
+    EffectQueue queue;
+    runBenchmark("EffectQueue push + applyAll", 20000000, [&](uint64_t i) {
+        queue.push(effects[i % 3]);
+        queue.applyAll(stats);
+        return stats.moves; });
+}
+
+// =================================================================================
+// === Entity-component systems ====================================================
+// =================================================================================
+void benchmarkEcs()
+{
+    const uint32_t enemies = 100000;
+    World world;
+    Rng rng(3);
+    for (uint32_t i = 0; i < enemies; ++i)
+        world.createCharacter("Goblin", rng.nextInt(15, 70), 0, 0);
+
+    runBenchmark("damageAll (per enemy)", 2000, [&](uint64_t) {
+        damageAll(world, 0);
+        return world.health.size(); }, enemies);
+    runBenchmark("World create + destroy", 5000000, [&](uint64_t) {
+        Entity e = world.createCharacter("Goblin", 20, 0, 0);
+        world.destroy(e);
+        return e; });
+}
+
+// =================================================================================
+// === Headless games ==============================================================
+// =================================================================================
+void benchmarkSimulation()
+{
+    const SimDungeonTemplate dungeon = builtinSimDungeon();
+    const BuiltinCampaignRooms campaign;
+    auto fightThenBypass = [](const SimSession &s, const auto &) {
+        return s.player.getHealth() >= 40 ? SimAction::Fight : SimAction::Bypass; };
+
+    runBenchmark("simulateGame (runtime template)", 1000000, [&](uint64_t game) {
+        SimSession session = startSession<GuiRules>(Rng(streamKey(42, game)));
+        return static_cast<uint64_t>(simulateGame(session, dungeon, fightThenBypass)); });
+    runBenchmark("simulateGame (constexpr campaign)", 1000000, [&](uint64_t game) {
+        SimSession session = startSession<GuiRules>(Rng(streamKey(42, game)));
+        return static_cast<uint64_t>(simulateGame(session, campaign, fightThenBypass)); });
+    runBenchmark("builtinSimDungeon (runtime build)", 10000, [](uint64_t) {
+        return static_cast<uint64_t>(builtinSimDungeon().rooms.size()); });
+    cout << "  sizeof(SimEnemy) = " << sizeof(SimEnemy) << " bytes (no vtable pointer)\n";
+}
+
+// =================================================================================
+// === Rule variants ===============================================================
+// =================================================================================
+template <typename Variant>
+void benchmarkVariant(const string &name)
+{
+    const BuiltinCampaignRooms campaign;
+    // Fights while healthy, sneaks past when hurt, and backtracks on every fifth move to exercise the history rules.
+    auto player = [](const SimSession &s, const BuiltinCampaignRooms &) {
+        if (s.player.getMoves() % 5 == 0)
+            return SimAction::Backtrack;
+        return s.player.getHealth() >= 40 ? SimAction::Fight : SimAction::Bypass; };
+
+    uint64_t played = 0, escapes = 0; // Includes runBenchmark's warm-up games.
+    runBenchmark("simulateGame<" + name + ">", 1000000, [&](uint64_t game) {
+        SimSession session = startSession<Variant>(Rng(streamKey(42, game)));
+        const SimStatus status = simulateGame<Variant>(session, campaign, player);
+        played++;
+        escapes += status == SimStatus::Escaped;
+        return static_cast<uint64_t>(status); });
+    cout << "  " << name << ": escaped " << setprecision(1) << (100.0 * escapes / played) << "% of " << played << " games\n";
+}
+
+void benchmarkRuleVariants()
+{
+    benchmarkVariant<GuiRules>("GuiRules");
+    benchmarkVariant<ConsoleRules>("ConsoleRules");
+}
+
+// =================================================================================
+// === Packed game state ===========================================================
+// =================================================================================
+void benchmarkGameState()
+{
+    // A mid-game session to snapshot: a few rooms in, with some loot.
+    const SimDungeonTemplate dungeon = builtinSimDungeon();
+    SimSession session = startSession<GuiRules>(Rng(42));
+    simulateTurn(session, dungeon, SimAction::Fight);
+    simulateTurn(session, dungeon, SimAction::Bypass);
+    const PackedState packed = packState(session);
+
+    // Every state of a few random games must survive a pack, unpack and pack unchanged.
+    for (uint64_t game = 0; game < 1000; ++game)
+    {
+        SimSession s = startSession<GuiRules>(Rng(streamKey(7, game)));
+        while (true)
+        {
+            const PackedState before = packState(s);
+            SimSession restored = startSession<GuiRules>(Rng(0));
+            unpackState(before, restored);
+            const PackedState after = packState(restored);
+            if (!(after == before) || after.hash() != before.hash() || restored.zobristHash() != s.zobristHash())
+                throw runtime_error("PackedState did not round-trip in game " + to_string(game) + ".");
+            if (s.status != SimStatus::Playing)
+                break;
+            simulateTurn(s, dungeon, static_cast<SimAction>(1 + s.rng.nextBelow(3)));
+        }
+    }
+
+    runBenchmark("packState (SimSession)", 20000000, [&](uint64_t i) {
+        session.roomIndex = static_cast<int>(i & 3);
+        return packState(session).hash(); });
+    runBenchmark("unpackState (SimSession)", 20000000, [&](uint64_t) {
+        unpackState(packed, session);
+        return static_cast<uint64_t>(session.player.getHealth()); });
+    runBenchmark("PackedState copy + hash", 50000000, [&](uint64_t i) {
+        PackedState copy = packed;
+        copy.setMoves(static_cast<int>(i & 15));
+        return copy.hash(); });
+    cout << "  sizeof(PackedState) = " << sizeof(PackedState) << " bytes, sizeof(SimSession) = " << sizeof(SimSession) << " bytes\n";
+}
+
+// =================================================================================
+// === Zobrist hashing and the transposition table =================================
+// =================================================================================
+void benchmarkTransposition()
+{
+    const SimDungeonTemplate dungeon = builtinSimDungeon();
+    SimSession session = startSession<GuiRules>(Rng(42));
+    simulateTurn(session, dungeon, SimAction::Fight);
+    simulateTurn(session, dungeon, SimAction::Bypass);
+
+    // The incremental hash must equal the hash computed from scratch after every turn of a random game.
+    for (uint64_t game = 0; game < 1000; ++game)
+    {
+        SimSession s = startSession<GuiRules>(Rng(streamKey(9, game)));
+        while (true)
+        {
+            if (s.zobristHash() != zobristHash(packState(s)))
+                throw runtime_error("Incremental Zobrist hash diverged from the packed state's in game " +
+                                    to_string(game) + ".");
+            if (s.status != SimStatus::Playing)
+                break;
+            simulateTurn(s, dungeon, static_cast<SimAction>(1 + s.rng.nextBelow(3)));
+        }
+    }
+
+    runBenchmark("zobristHash (incremental, SimSession)", 50000000, [&](uint64_t i) {
+        session.player.takeDamage(static_cast<int>(i & 1));
+        return session.zobristHash(); });
+    runBenchmark("zobristHash (packState + from scratch)", 20000000, [&](uint64_t i) {
+        session.player.takeDamage(static_cast<int>(i & 1));
+        return zobristHash(packState(session)); });
+
+    TranspositionTable table(1 << 20);
+    TranspositionStats stats;
+    runBenchmark("TranspositionTable::store", 20000000, [&](uint64_t i) {
+        table.store(mix64(i & 0xFFFFF), {0.5f, 1}, stats);
+        return i; });
+    runBenchmark("TranspositionTable::probe", 20000000, [&](uint64_t i) {
+        Evaluation evaluation{};
+        return static_cast<uint64_t>(table.probe(mix64(i & 0x1FFFFF), evaluation, stats)); });
+
+    // Threads play random games and share one table, as parallel bots would; states recur across games.
+    table.clear();
+    const int threadCount = static_cast<int>(std::max(2u, std::min(8u, thread::hardware_concurrency())));
+    const uint64_t gamesPerThread = 200000;
+    vector<TranspositionStats> threadStats(threadCount);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t] {
+            for (uint64_t game = 0; game < gamesPerThread; ++game)
+            {
+                SimSession s = startSession<GuiRules>(Rng(streamKey(t, game)));
+                while (s.status == SimStatus::Playing)
+                {
+                    Evaluation evaluation{};
+                    if (!table.probe(s.zobristHash(), evaluation, threadStats[t]))
+                        table.store(s.zobristHash(), {1.0f, 1}, threadStats[t]);
+                    simulateTurn(s, dungeon, static_cast<SimAction>(1 + s.rng.nextBelow(3)));
+                }
+            }
+        });
+    }
+    for (thread &th : threads)
+        th.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    TranspositionStats total;
+    for (const TranspositionStats &t : threadStats)
+        total += t;
+    cout << "  " << threadCount << " threads sharing a " << table.size() << "-slot table: " << total.probes << " probes, hit rate "
+         << setprecision(1) << (100.0 * total.hitRate()) << "%, " << setprecision(1) << (total.probes / seconds / 1e6) << " M probes/s\n";
+}
+
+// =================================================================================
+// === Monte Carlo tree search bot =================================================
+// =================================================================================
+void benchmarkMcts()
+{
+    const BuiltinCampaignRooms campaign;
+    const SimSession start = startSession<GuiRules>(Rng(42));
+    MctsSearch<BuiltinCampaignRooms> search(campaign);
+    search.reset(start);
+    runBenchmark("MctsSearch::iterate (per iteration)", 1000000, [&](uint64_t) {
+        search.iterate(1);
+        return search.getNodeCount(); });
+
+    const unsigned threadCount = std::max(2u, std::min(8u, thread::hardware_concurrency()));
+    const uint64_t iterations = 400000;
+    for (unsigned threads : {1u, threadCount})
+    {
+        auto begin = chrono::steady_clock::now();
+        SimAction action = mctsChooseParallel(campaign, start, iterations / threads, threads, 7);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        cout << "  mctsChooseParallel, " << iterations << " iterations on " << threads << " thread(s): " << setprecision(1) << ms
+             << " ms (chose " << static_cast<int>(action) << ")\n";
+    }
+
+    const uint64_t games = 2000;
+    for (uint64_t perMove : {50u, 500u})
+    {
+        auto begin = chrono::steady_clock::now();
+        double rate = mctsEscapeRate(campaign, games, perMove, threadCount, 7);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        cout << "  bot with " << perMove << " iterations/move: escaped " << setprecision(1) << (100.0 * rate) << "% of " << games
+             << " games (" << setprecision(2) << seconds << " s on " << threadCount << " threads)\n";
+    }
+}
+
+// =================================================================================
+// === Vectorized training environment =============================================
+// =================================================================================
+void benchmarkEnv()
+{
+    for (size_t count : {256u, 4096u, 65536u})
+    {
+        VectorEnv<> env(count);
+        env.reset(42);
+        // Pre-drawn random actions (Fight/Bypass/Backtrack), so the measurement is the environment alone.
+        const size_t rounds = 16;
+        vector<SimAction> actions(count * rounds);
+        Rng rng(7);
+        for (SimAction &action : actions)
+            action = static_cast<SimAction>(1 + rng.nextBelow(3));
+
+        uint64_t episodes = 0;
+        runBenchmark("VectorEnv::step (" + to_string(count) + " envs, per env)", 40000000 / count, [&](uint64_t round) {
+            env.step(actions.data() + (round % rounds) * count);
+            for (size_t i = 0; i < count; ++i)
+                episodes += env.done[i];
+            return episodes; }, count);
+    }
+}
+
+// =================================================================================
+// === Exact analysis (absorbing Markov chain) =====================================
+// =================================================================================
+void benchmarkMarkov()
+{
+    const BuiltinCampaignRooms campaign;
+    auto policy = [](const PackedState &state) { return state.health() >= 50 ? SimAction::Fight : SimAction::Bypass; };
+
+    // Every starting health from 20 to 100 with 1 to 10 moves.
+    vector<PackedState> starts;
+    for (int health = 20; health <= 100; ++health)
+        for (int moves = 1; moves <= 10; ++moves)
+            starts.push_back(startingState(health, moves));
+
+    MarkovAnalyzer<BuiltinCampaignRooms> analyzer(campaign);
+    auto begin = chrono::steady_clock::now();
+    analyzer.build(starts, policy);
+    auto built = chrono::steady_clock::now();
+    const MarkovStats &stats = analyzer.solve();
+    auto solved = chrono::steady_clock::now();
+    cout << "  MarkovAnalyzer: " << stats.states << " states, " << stats.transitions << " transitions; build "
+         << setprecision(2) << chrono::duration<double>(built - begin).count() << " s, solve "
+         << chrono::duration<double>(solved - built).count() << " s (" << stats.sweeps << " sweeps)\n";
+
+    const AbsorptionOdds odds = analyzer.result(startingState());
+    const uint64_t games = 200000;
+    uint64_t escapes = 0;
+    for (uint64_t game = 0; game < games; ++game)
+    {
+        SimSession session = startSession<GuiRules>(Rng(streamKey(42, game)));
+        auto play = [&](const SimSession &s, const BuiltinCampaignRooms &) { return policy(packState(s)); };
+        escapes += simulateGame(session, campaign, play) == SimStatus::Escaped;
+    }
+    const double sampled = static_cast<double>(escapes) / games;
+    cout << "  fight at 50+ health from a fresh game: escape " << setprecision(6) << odds.escaped << ", die " << odds.died
+         << ", out of moves " << odds.outOfMoves << "; " << games << " sampled games escape " << sampled << "\n";
+
+    // The sampled rate must agree with the exact odds to within five standard errors of the sample.
+    const double standardError = sqrt(odds.escaped * (1.0 - odds.escaped) / games);
+    if (fabs(sampled - odds.escaped) > 5.0 * standardError + 1e-9)
+        throw runtime_error("Sampled escape rate " + to_string(sampled) + " disagrees with the exact odds " +
+                            to_string(odds.escaped) + ".");
+}
+
+// =================================================================================
+// === Balance tuning ==============================================================
+// =================================================================================
+void benchmarkBalance()
+{
+    const BuiltinCampaignRooms campaign;
+    BalanceConfig config;
+    config.threads = std::max(2u, std::min(8u, thread::hardware_concurrency()));
+    // A reckless player (fights down to 30 health) should escape 40% of the time, a careful one (60) 80%.
+    BalanceTuner<BuiltinCampaignRooms> tuner(campaign, {{ThresholdPolicy{30}, 0.4}, {ThresholdPolicy{60}, 0.8}}, config);
+    const BalanceParams current = currentBalance(campaign);
+
+    auto begin = chrono::steady_clock::now();
+    const BalanceResult before = tuner.evaluate(current);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    cout << "  BalanceTuner::evaluate (" << config.games << " games x 2 targets, " << config.threads << " threads): " << setprecision(1)
+         << ms << " ms\n";
+    cout << "  current:  " << describeBalance(current) << " -> escape " << setprecision(3) << before.escapeRates[0] << " / "
+         << before.escapeRates[1] << "\n";
+
+    begin = chrono::steady_clock::now();
+    const BalanceResult tuned = tuner.optimize(current);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    cout << "  tuned:    " << describeBalance(tuned.params) << " -> escape " << setprecision(3) << tuned.escapeRates[0] << " / "
+         << tuned.escapeRates[1] << " (" << tuner.getEvaluations() - 1 << " candidates, " << setprecision(2) << seconds << " s)\n";
+}
+
+// =================================================================================
+// === Timed input sessions ========================================================
+// =================================================================================
+void benchmarkTimedInput()
+{
+    // Many sessions on one thread: each is a pipe; every round answers a random session and polls once.
+    for (size_t count : {16u, 1024u})
+    {
+        InputMux mux;
+        vector<int> writers(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            int ends[2];
+            if (pipe(ends) != 0)
+                throw runtime_error("pipe failed");
+            writers[i] = ends[1];
+            mux.add(ends[0]);
+        }
+        vector<MuxEvent> events;
+        Rng rng(3);
+        uint64_t words = 0;
+        runBenchmark("InputMux::wait (" + to_string(count) + " sessions)", 200000, [&](uint64_t) {
+            const int session = static_cast<int>(rng.nextBelow(static_cast<uint32_t>(count)));
+            if (write(writers[session], "1\n", 2) != 2)
+                throw runtime_error("write failed");
+            mux.wait(events);
+            string_view word;
+            for (const MuxEvent &event : events)
+                while (mux.reader(event.session).nextWord(word))
+                    words++;
+            return words; });
+        for (int fd : writers)
+            close(fd);
+    }
+
+    // Deadline accuracy: 1000 silent sessions with deadlines spread over 50 ms.
+    InputMux mux;
+    vector<int> writers;
+    const auto start = MonoClock::now();
+    for (int i = 0; i < 1000; ++i)
+    {
+        int ends[2];
+        if (pipe(ends) != 0)
+            throw runtime_error("pipe failed");
+        writers.push_back(ends[1]);
+        mux.setDeadline(mux.add(ends[0]), start + chrono::microseconds(5000 + 45 * i));
+    }
+    vector<MuxEvent> events;
+    size_t fired = 0;
+    double worstLateUs = 0.0, totalLateUs = 0.0;
+    while (fired < writers.size())
+    {
+        mux.wait(events);
+        const auto now = MonoClock::now();
+        for (const MuxEvent &event : events)
+        {
+            const double late = chrono::duration<double, micro>(now - (start + chrono::microseconds(5000 + 45 * event.session))).count();
+            worstLateUs = std::max(worstLateUs, late);
+            totalLateUs += late;
+            fired++;
+        }
+    }
+    for (int fd : writers)
+        close(fd);
+    cout << "  1000 session deadlines: mean " << setprecision(0) << totalLateUs / 1000 << " us late, worst " << worstLateUs
+         << " us (waits round up to whole ms)\n";
+}
+
+// =================================================================================
+// === Timer wheel =================================================================
+// =================================================================================
+void benchmarkTimerWheel()
+{
+    // Timers due on a level boundary reach level 0 on the very tick they are due; each must fire on that tick.
+    {
+        TimerWheel<uint64_t> wheel(chrono::milliseconds(1), MonoClock::time_point{});
+        const uint64_t boundaries[] = {255, 256, 257, 512, 65535, 65536, 65537, uint64_t(1) << 24, uint64_t(1) << 32};
+        for (uint64_t due : boundaries)
+            wheel.scheduleAtTick(due, due);
+        while (wheel.size() > 0)
+        {
+            wheel.advanceToTick(wheel.currentTick() + wheel.ticksUntilNext(), [&](uint64_t due) {
+                if (due != wheel.currentTick())
+                    throw runtime_error("TimerWheel fired the timer due at tick " + to_string(due) + " at tick " +
+                                        to_string(wheel.currentTick()) + "."); });
+        }
+    }
+
+    // 10^6 active timers at millisecond ticks, due within ten minutes, against an ordered multimap of the same timers.
+    const uint32_t timerCount = 1000000;
+    const uint32_t horizon = 600000;
+    Rng rng(5);
+
+    TimerWheel<uint32_t> wheel(chrono::milliseconds(1), MonoClock::time_point{});
+    wheel.reserve(timerCount);
+    vector<TimerHandle> handles(timerCount);
+    auto begin = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < timerCount; ++i)
+        handles[i] = wheel.scheduleAtTick(1 + rng.nextBelow(horizon), i);
+    const double wheelFillNs = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / timerCount;
+
+    multimap<uint64_t, uint32_t> ordered;
+    vector<multimap<uint64_t, uint32_t>::iterator> positions(timerCount);
+    begin = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < timerCount; ++i)
+        positions[i] = ordered.emplace(1 + rng.nextBelow(horizon), i);
+    const double orderedFillNs = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / timerCount;
+    cout << "  schedule 10^6 timers: wheel " << fixed << setprecision(1) << wheelFillNs << " ns, multimap " << orderedFillNs << " ns per timer\n";
+
+    // Moving a deadline: cancel a random timer and schedule it again, so 10^6 stay active.
+    runBenchmark("TimerWheel reschedule (10^6 active)", 1000000, [&](uint64_t) {
+        const uint32_t i = rng.nextBelow(timerCount);
+        wheel.cancel(handles[i]);
+        handles[i] = wheel.scheduleAtTick(1 + rng.nextBelow(horizon), i);
+        return handles[i].index; });
+    runBenchmark("multimap reschedule (10^6 active)", 1000000, [&](uint64_t) {
+        const uint32_t i = rng.nextBelow(timerCount);
+        ordered.erase(positions[i]);
+        positions[i] = ordered.emplace(1 + rng.nextBelow(horizon), i);
+        return positions[i]->second; });
+
+    // Draining: advance 16 ms per step (one 60 fps frame) until every timer has fired.
+    uint64_t sum = 0, frames = 0;
+    size_t fired = 0;
+    begin = chrono::steady_clock::now();
+    while (wheel.size() > 0)
+    {
+        fired += wheel.advanceToTick(wheel.currentTick() + 16, [&](uint32_t i) { sum += i; });
+        frames++;
+    }
+    const double wheelDrainNs = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / static_cast<double>(fired);
+
+    uint64_t orderedNow = 0;
+    begin = chrono::steady_clock::now();
+    while (!ordered.empty())
+    {
+        orderedNow += 16;
+        while (!ordered.empty() && ordered.begin()->first <= orderedNow)
+        {
+            sum += ordered.begin()->second;
+            ordered.erase(ordered.begin());
+        }
+    }
+    const double orderedDrainNs = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / timerCount;
+    benchmarkSink = benchmarkSink + sum;
+    cout << "  fire 10^6 timers over " << frames << " frames: wheel " << wheelDrainNs << " ns, multimap " << orderedDrainNs
+         << " ns per timer\n";
+}
+
+int main()
+{
+    cout << "Dungeon Escape benchmarks\n\n";
+    benchmarkRandom();
+    benchmarkCombat();
+    benchmarkLoot();
+    benchmarkInventory();
+    benchmarkEffects();
+    benchmarkEcs();
+    benchmarkSimulation();
+    benchmarkRuleVariants();
+    benchmarkGameState();
+    benchmarkTransposition();
+    benchmarkMcts();
+    benchmarkEnv();
+    benchmarkMarkov();
+    benchmarkBalance();
+    benchmarkTimedInput();
+    benchmarkTimerWheel();
+    return 0;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>     // Required for fixed-width integer types
+#include <cstddef>     // Required for size_t
+#include <string_view> // Required for compile-time text
+#include <array>       // Required for std::array (campaign tables)
+#include <vector>      // Required for std::vector (loot odds)
+
+#include "items.h"  // builtinItemId
+#include "loot.h"   // FixedAliasTable, makeFixedAliasTable, LootOdds
+
+// =================================================================================
+// === The built-in campaign, fixed at compile time ================================
+// =================================================================================
+
+/**
+ * @brief Compile-time description of one room of the built-in campaign.
+ * All text points into the program's read-only data, so the tables need no construction at startup.
+ */
+struct RoomDef
+{
+    std::string_view name;             // Room name, e.g. "Bronze".
+    std::string_view enemyName;        // Name of the room's enemy.
+    std::string_view enemyDescription; // Flavour text of the enemy.
+    int enemyHealth;                   // Strength to beat; also the damage the enemy deals.
+    std::string_view item1;            // First item of the room's treasure.
+    std::string_view item2;            // Second item of the room's treasure.
+    std::string_view key;              // The room's key.
+    std::string_view challenge;        // The room's challenge text.
+    int timeLimitSeconds = 0;          // Time to leave the room once entered, enforced by timed console play; 0 for none.
+};
+
+/**
+ * @brief The five rooms of the built-in campaign, in play order. Both games and the headless engine read this table.
+ */
+inline constexpr std::array<RoomDef, 5> builtinCampaign = {{
+    {"Base", "Shadow Stalker", "A stealthy, dark creature.", 15, "5 Coins", "Armour", "Key1", "Collect 5 coins"},
+    {"Bronze", "Viper", "A venomous menace.", 25, "5 Coins", "Health Booster Potion", "Key2", "Exit the room within 5 seconds", 5},
+    {"Platinum", "Crawler", "A fast, wall-climbing creature.", 35, "Health Booster Potion", "Armour", "Key3", "Defeat the enemy without armour"},
+    {"Silver", "Hunter", "A swift and deadly assassin.", 50, "5 Coins", "Armour", "Key4",
+     "Riddle: I have no voice, but I can teach you all I know. What am I? (Answer: book)"},
+    {"Gold", "Boss", "The ultimate challenge.", 70, "5 Coins", "Health Booster Potion", "Key5", "Defeat the boss"},
+}};
+
+/**
+ * @brief The game's balance constants besides the enemies' health (which lives in the campaign table).
+ */
+struct RuleSet
+{
+    int fleeDamage;    // Damage taken when losing a fight.
+    int bypassDamage;  // Damage taken when sneaking past an enemy.
+    int timeoutDamage; // Damage taken when a room's time limit runs out (the games only; the engine has no clock).
+    int winCoins;      // Coins for defeating an enemy (ranking only; no rule reads coins).
+    int startMoves;    // Moves at the start of a game.
+    int minHealth;     // The game is lost once health drops below this.
+};
+
+/**
+ * @brief The rules both games play by. The headless engine reads them through its room interface, so a tuner can
+ * try other values without touching the games.
+ */
+inline constexpr RuleSet builtinRules = {10, 5, 5, 10, 10, 20};
+
+/**
+ * @brief One weighted drop of a room's loot table.
+ */
+struct DropDef
+{
+    std::string_view item;
+    double weight;
+};
+
+// Every room's loot table has this many drops.
+const size_t roomDropCount = 5;
+
+/**
+ * @brief The loot drops of a room tier. The room's own treasure is the common drop; coins and the room's key
+ * become likelier the deeper the room.
+ * @param room The room's definition.
+ * @param tier The room's position in the campaign (0 for the first room).
+ * @return The drops, in the order the loot table lists them.
+ */
+constexpr std::array<DropDef, roomDropCount> roomDrops(const RoomDef &room, size_t tier)
+{
+    return {{{room.item1, 4.0},
+             {room.item2, 4.0},
+             {"10 Coins", 1.0 + tier},
+             {room.key, 0.5 + 0.25 * tier},
+             {"Hourglass", 1.0}}};
+}
+
+/**
+ * @brief A room's loot table in compiled form: built-in ItemIds plus a FixedAliasTable over the drop weights.
+ */
+struct CompiledLoot
+{
+    std::array<ItemId, roomDropCount> items{};
+    FixedAliasTable<roomDropCount> table{};
+
+    /**
+     * @brief Rolls one drop, with the same distribution and random draws as LootTable::roll.
+     * @param rng The random stream to draw from.
+     * @return The ID of the dropped item.
+     */
+    ItemId roll(Rng &rng) const { return items[table.sample(rng.next())]; }
+
+    /**
+     * @brief Gets every drop with its exact probability, like LootTable::odds.
+     */
+    std::vector<LootOdds> odds() const
+    {
+        const std::array<double, roomDropCount> probabilities = table.probabilities();
+        std::vector<LootOdds> drops;
+        for (size_t i = 0; i < roomDropCount; ++i)
+            drops.push_back({items[i], probabilities[i]});
+        return drops;
+    }
+};
+
+/**
+ * @brief Compiles a room's drops. Every drop must be a built-in item; anything else fails to compile.
+ * @param room The room's definition.
+ * @param tier The room's position in the campaign.
+ * @return The compiled loot table.
+ */
+constexpr CompiledLoot compileRoomLoot(const RoomDef &room, size_t tier)
+{
+    const std::array<DropDef, roomDropCount> drops = roomDrops(room, tier);
+    CompiledLoot loot{};
+    std::array<double, roomDropCount> weights{};
+    for (size_t i = 0; i < roomDropCount; ++i)
+    {
+        loot.items[i] = builtinItemId(drops[i].item);
+        weights[i] = drops[i].weight;
+    }
+    loot.table = makeFixedAliasTable(weights);
+    return loot;
+}
+
+/**
+ * @brief Compiles the loot table of every room of a campaign.
+ * @tparam N The number of rooms.
+ * @param campaign The campaign's rooms.
+ * @return One compiled loot table per room.
+ */
+template <size_t N>
+constexpr std::array<CompiledLoot, N> compileCampaignLoot(const std::array<RoomDef, N> &campaign)
+{
+    std::array<CompiledLoot, N> loot{};
+    for (size_t tier = 0; tier < N; ++tier)
+        loot[tier] = compileRoomLoot(campaign[tier], tier);
+    return loot;
+}
+
+// The built-in campaign's loot, computed by the compiler and stored as read-only data.
+inline constexpr std::array<CompiledLoot, builtinCampaign.size()> builtinCampaignLoot = compileCampaignLoot(builtinCampaign);
+
+static_assert(builtinCampaignLoot[0].items[0] == builtinItemId("5 Coins"), "Campaign loot must resolve to built-in items");
+static_assert(builtinCampaignLoot[4].items[3] == builtinItemId("Key5"), "Campaign loot must resolve to built-in items");
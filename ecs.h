@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>       // Required for fixed-width integer types
+#include <cstddef>       // Required for size_t
+#include <string>        // Required for names
+#include <string_view>   // Required for name lookup without copies
+#include <vector>        // Required for dense component storage
+#include <deque>         // Required for std::deque (name storage that never moves)
+#include <unordered_map> // Required for name interning
+#include <algorithm>     // Required for std::max
+#include <stdexcept>     // Required for std::out_of_range
+
+using Entity = uint32_t; // Index of an entity in its World.
+using NameId = uint32_t; // Index of an interned name in a NameTable.
+
+const Entity invalidEntity = 0xFFFFFFFFu;
+
+/**
+ * @brief Interns strings so entities store a 4-byte NameId instead of a std::string each.
+ * Thousands of "Goblin" enemies share one copy of the text.
+ */
+class NameTable
+{
+private:
+    std::deque<std::string> names;                       // Text indexed by NameId; adding a name never moves the others.
+    std::unordered_map<std::string_view, NameId> lookup; // Views into names -> NameId.
+
+public:
+    /**
+     * @brief Returns the ID of a name, adding it if it is new.
+     * @param name The text to intern.
+     * @return The name's ID.
+     */
+    NameId intern(std::string_view name)
+    {
+        auto found = lookup.find(name);
+        if (found != lookup.end())
+            return found->second;
+        NameId id = static_cast<NameId>(names.size());
+        names.emplace_back(name);
+        lookup.emplace(names.back(), id);
+        return id;
+    }
+
+    /**
+     * @brief Gets the text of an interned name.
+     * @param id The name's ID.
+     * @return A constant reference to the text; stays valid while the table lives.
+     */
+    const std::string &get(NameId id) const { return names[id]; }
+};
+
+/**
+ * @brief Sparse-set storage of one component type.
+ * Components are packed densely (no holes), so systems iterate a contiguous array; the sparse index gives
+ * O(1) lookup, insertion and swap-removal by entity.
+ * @tparam T The component type.
+ */
+template <typename T>
+class ComponentPool
+{
+private:
+    static constexpr uint32_t absent = 0xFFFFFFFFu;
+    std::vector<uint32_t> sparse; // Entity -> index into dense arrays, or absent.
+    std::vector<Entity> owners;   // Dense index -> owning entity.
+    std::vector<T> items;         // Dense component data.
+
+public:
+    /**
+     * @brief Adds or replaces an entity's component.
+     */
+    void insert(Entity e, const T &value)
+    {
+        if (e >= sparse.size())
+            sparse.resize(static_cast<size_t>(e) + 1, absent);
+        if (sparse[e] != absent)
+        {
+            items[sparse[e]] = value;
+            return;
+        }
+        sparse[e] = static_cast<uint32_t>(items.size());
+        owners.push_back(e);
+        items.push_back(value);
+    }
+
+    /**
+     * @brief Removes an entity's component by moving the last component into its slot.
+     */
+    void remove(Entity e)
+    {
+        if (!has(e))
+            return;
+        const uint32_t slot = sparse[e];
+        const Entity last = owners.back();
+        items[slot] = items.back();
+        owners[slot] = last;
+        sparse[last] = slot;
+        items.pop_back();
+        owners.pop_back();
+        sparse[e] = absent;
+    }
+
+    bool has(Entity e) const { return e < sparse.size() && sparse[e] != absent; }
+
+    /**
+     * @brief Gets an entity's component.
+     * @throws out_of_range If the entity has no such component.
+     */
+    T &get(Entity e)
+    {
+        if (!has(e))
+            throw std::out_of_range("Entity has no such component.");
+        return items[sparse[e]];
+    }
+
+    const T &get(Entity e) const { return const_cast<ComponentPool *>(this)->get(e); }
+
+    size_t size() const { return items.size(); }
+    T *data() { return items.data(); }
+    const T *data() const { return items.data(); }
+    const Entity *entities() const { return owners.data(); }
+};
+
+/**
+ * @brief Attack and defense of a combatant (see CombatStats).
+ */
+struct StatsComponent
+{
+    int attack;
+    int defense;
+};
+
+/**
+ * @brief Entity-component storage for every character in a game or simulation.
+ * Each component lives in its own dense pool, so per-turn systems touch only the data they need
+ * (health, names, stats) instead of whole objects.
+ */
+class World
+{
+private:
+    std::vector<Entity> freeEntities; // Destroyed IDs available for reuse.
+    Entity nextEntity = 0;            // First never-used ID.
+    size_t alive = 0;                 // Number of live entities.
+
+public:
+    ComponentPool<int32_t> health;       // Current health.
+    ComponentPool<NameId> names;         // Interned display name.
+    ComponentPool<StatsComponent> stats; // Attack and defense.
+    NameTable nameTable;                 // Text of every name.
+
+    /**
+     * @brief Creates a new entity with no components.
+     * @return The entity's ID.
+     */
+    Entity create()
+    {
+        ++alive;
+        if (!freeEntities.empty())
+        {
+            Entity e = freeEntities.back();
+            freeEntities.pop_back();
+            return e;
+        }
+        return nextEntity++;
+    }
+
+    /**
+     * @brief Creates a combatant with health, name and stats.
+     */
+    Entity createCharacter(const std::string &name, int hp, int attack, int defense)
+    {
+        Entity e = create();
+        health.insert(e, hp);
+        names.insert(e, nameTable.intern(name));
+        stats.insert(e, {attack, defense});
+        return e;
+    }
+
+    /**
+     * @brief Creates a new entity with copies of another entity's components.
+     * @param source The entity to copy.
+     * @return The new entity's ID.
+     */
+    Entity clone(Entity source)
+    {
+        Entity e = create();
+        // Copy each value out before inserting: insert() may reallocate the pool it was read from.
+        if (health.has(source))
+        {
+            int32_t value = health.get(source);
+            health.insert(e, value);
+        }
+        if (names.has(source))
+        {
+            NameId value = names.get(source);
+            names.insert(e, value);
+        }
+        if (stats.has(source))
+        {
+            StatsComponent value = stats.get(source);
+            stats.insert(e, value);
+        }
+        return e;
+    }
+
+    /**
+     * @brief Destroys an entity and all of its components; its ID may be reused.
+     */
+    void destroy(Entity e)
+    {
+        health.remove(e);
+        names.remove(e);
+        stats.remove(e);
+        freeEntities.push_back(e);
+        --alive;
+    }
+
+    /**
+     * @brief Gets the number of live entities.
+     */
+    size_t size() const { return alive; }
+};
+
+/**
+ * @brief The world used by the interactive game's characters.
+ * @return A reference to the process-wide world.
+ */
+inline World &defaultWorld()
+{
+    static World world;
+    return world;
+}
+
+/**
+ * @brief System: deals the same damage to every entity with health (e.g. a trap hitting a whole level).
+ * @param world The world to update.
+ * @param damage The damage to deal.
+ */
+inline void damageAll(World &world, int damage)
+{
+    int32_t *hp = world.health.data();
+    for (size_t i = 0, n = world.health.size(); i < n; ++i)
+        hp[i] = std::max(0, hp[i] - damage);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <vector>    // Required for std::vector (batch columns)
+#include <array>     // Required for std::array (pending effect queue)
+#include <algorithm> // Required for std::min, std::max
+
+/**
+ * @brief What an item does when its effect is applied.
+ */
+enum class EffectKind : uint8_t
+{
+    None,            // Inert item.
+    Heal,            // Restores health, up to effectMaxHealth.
+    DamageReduction, // Raises defense, which combat subtracts from damage taken.
+    ExtraMoves,      // Grants additional moves.
+    Count            // Number of kinds; keep last.
+};
+
+/**
+ * @brief One effect with its strength (e.g. Heal 25).
+ */
+struct Effect
+{
+    EffectKind kind = EffectKind::None;
+    int16_t magnitude = 0;
+};
+
+/**
+ * @brief The stats effects act on.
+ */
+struct EffectStats
+{
+    int health;
+    int defense;
+    int moves;
+};
+
+// Health can never be healed above this value (matches Player::heal).
+const int effectMaxHealth = 100;
+
+/**
+ * @brief Per-kind coefficients: applying an effect adds magnitude * coefficient to each stat.
+ * Dispatch is a table lookup plus three multiply-adds, so there are no virtual or indirect calls per effect,
+ * and the same rule serves the scalar and batch paths. Add a kind by adding a row.
+ */
+struct EffectRule
+{
+    int8_t health, defense, moves;
+};
+
+const EffectRule effectRules[static_cast<size_t>(EffectKind::Count)] = {
+    {0, 0, 0}, // None
+    {1, 0, 0}, // Heal
+    {0, 1, 0}, // DamageReduction
+    {0, 0, 1}, // ExtraMoves
+};
+
+/**
+ * @brief Applies one effect to a set of stats.
+ * @param stats The stats to modify.
+ * @param effect The effect to apply.
+ */
+inline void applyEffect(EffectStats &stats, const Effect &effect)
+{
+    const EffectRule &rule = effectRules[static_cast<size_t>(effect.kind)];
+    stats.health = std::min(effectMaxHealth, stats.health + effect.magnitude * rule.health);
+    stats.defense += effect.magnitude * rule.defense;
+    stats.moves += effect.magnitude * rule.moves;
+}
+
+/**
+ * @brief Small fixed-capacity queue of effects waiting to be applied at the end of a turn.
+ * Lives inside the Player, so queueing never allocates.
+ */
+class EffectQueue
+{
+private:
+    std::array<Effect, 8> pending; // Effects in the order they were queued.
+    size_t count = 0;
+
+public:
+    /**
+     * @brief Queues an effect.
+     * @param effect The effect to queue; None is ignored.
+     * @return False if the queue is full and the effect was not queued.
+     */
+    bool push(const Effect &effect)
+    {
+        if (effect.kind == EffectKind::None)
+            return true;
+        if (count == pending.size())
+            return false;
+        pending[count++] = effect;
+        return true;
+    }
+
+    /**
+     * @brief Applies every queued effect in order and empties the queue.
+     * @param stats The stats to modify.
+     */
+    void applyAll(EffectStats &stats)
+    {
+        for (size_t i = 0; i < count; ++i)
+            applyEffect(stats, pending[i]);
+        count = 0;
+    }
+
+    /**
+     * @brief Gets the number of queued effects.
+     */
+    size_t size() const { return count; }
+};
+
+/**
+ * @brief Structure-of-arrays stats of many simulated players plus all their pending effects.
+ * Effects are stored as flat columns tagged with the player they belong to, so one pass applies all of them.
+ */
+struct EffectBatch
+{
+    std::vector<int32_t> health, defense, moves; // One entry per player.
+    std::vector<uint32_t> effectPlayer;          // Player index of each pending effect.
+    std::vector<EffectKind> effectKind;          // Kind of each pending effect.
+    std::vector<int16_t> effectMagnitude;        // Magnitude of each pending effect.
+
+    /**
+     * @brief Queues an effect for a player.
+     */
+    void push(uint32_t player, const Effect &effect)
+    {
+        effectPlayer.push_back(player);
+        effectKind.push_back(effect.kind);
+        effectMagnitude.push_back(effect.magnitude);
+    }
+
+    /**
+     * @brief Drops all pending effects, keeping their capacity for the next turn.
+     */
+    void clearEffects()
+    {
+        effectPlayer.clear();
+        effectKind.clear();
+        effectMagnitude.clear();
+    }
+};
+
+/**
+ * @brief Applies every pending effect of a batch in one pass, then clears them.
+ * Effects on the same player are applied in the order they were queued, as EffectQueue::applyAll() does.
+ * @param batch The players and their pending effects.
+ */
+inline void applyEffectsBatch(EffectBatch &batch)
+{
+    const size_t count = batch.effectPlayer.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t p = batch.effectPlayer[i];
+        const EffectRule &rule = effectRules[static_cast<size_t>(batch.effectKind[i])];
+        const int magnitude = batch.effectMagnitude[i];
+        batch.health[p] = std::min(effectMaxHealth, batch.health[p] + magnitude * rule.health);
+        batch.defense[p] += magnitude * rule.defense;
+        batch.moves[p] += magnitude * rule.moves;
+    }
+    batch.clearEffects();
+}
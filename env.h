@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint> // Required for fixed-width integer types
+#include <cstddef> // Required for size_t
+#include <vector>  // Required for std::vector (environment and observation storage)
+
+#include "random.h"     // Rng, streamKey
+#include "simulation.h" // SimSession, simulateTurn, BuiltinCampaignRooms
+
+/**
+ * @brief Gym-style vector of N independent games for training agents.
+ * Every environment follows the same rules as the games (simulateTurn). Observations, rewards and done flags are
+ * written into structure-of-arrays buffers, one entry per environment, so an agent reads each feature as one
+ * contiguous array. A finished environment restarts on its next episode stream in the same step (auto-reset), and
+ * its final status is kept in finalStatus. All storage is allocated by the constructor; reset() and step() never
+ * allocate.
+ * @tparam Rooms The dungeon's room interface (see simulateTurn); the built-in campaign by default.
+ * @tparam Variant The rules (GuiRules or ConsoleRules); episodes start at its opening position.
+ */
+template <typename Rooms = BuiltinCampaignRooms, typename Variant = GuiRules>
+class VectorEnv
+{
+private:
+    Rooms rooms;
+    std::vector<SimSession> sessions;
+    std::vector<uint64_t> episodes; // Episodes started per environment (picks the next episode's stream).
+    uint64_t seed = 0;
+
+    void startEpisode(size_t i)
+    {
+        sessions[i] = startSession<Variant>(Rng(streamKey(streamKey(seed, i), episodes[i]++)), rooms.rules().startMoves);
+    }
+
+    void observe(size_t i)
+    {
+        const SimSession &s = sessions[i];
+        health[i] = s.player.getHealth();
+        moves[i] = s.player.getMoves();
+        defense[i] = s.player.getDefense();
+        coins[i] = s.player.getCoins();
+        room[i] = s.roomIndex;
+        historyDepth[i] = s.historyDepth;
+        inventory[i] = s.player.getInventory().mask();
+    }
+
+public:
+    // Observations after the last reset() or step(), indexed by environment.
+    std::vector<int32_t> health, moves, defense, coins, room, historyDepth;
+    std::vector<uint64_t> inventory; // Held item kinds (bit i = ItemId i).
+    std::vector<float> reward;       // 1 for the step that escaped, 0 otherwise.
+    std::vector<uint8_t> done;       // 1 if the episode ended in the last step (the environment has been reset).
+    std::vector<SimStatus> finalStatus; // How the ended episode finished; Playing if it did not end.
+
+    /**
+     * @brief Constructor for the VectorEnv class.
+     * @param count Number of parallel environments.
+     * @param dungeon The dungeon every environment plays.
+     */
+    explicit VectorEnv(size_t count, const Rooms &dungeon = Rooms())
+        : rooms(dungeon), sessions(count), episodes(count, 0), health(count), moves(count), defense(count), coins(count),
+          room(count), historyDepth(count), inventory(count), reward(count), done(count), finalStatus(count)
+    {
+    }
+
+    /**
+     * @brief Starts a new episode in every environment. The same seed always gives the same episodes.
+     * @param newSeed The seed of the whole vector; environment i draws its episodes from streamKey(seed, i).
+     */
+    void reset(uint64_t newSeed)
+    {
+        seed = newSeed;
+        for (size_t i = 0; i < sessions.size(); ++i)
+        {
+            episodes[i] = 0;
+            startEpisode(i);
+            observe(i);
+            reward[i] = 0.0f;
+            done[i] = 0;
+            finalStatus[i] = SimStatus::Playing;
+        }
+    }
+
+    /**
+     * @brief Plays one turn in a range of environments. Disjoint ranges may be stepped from different threads.
+     * @param actions One action per environment (indexed like the observations; values are the choices 1-4).
+     * @param first The first environment to step.
+     * @param last One past the last environment to step.
+     */
+    void stepRange(const SimAction *actions, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            const SimStatus status = simulateTurn<Variant>(sessions[i], rooms, actions[i]);
+            reward[i] = status == SimStatus::Escaped ? 1.0f : 0.0f;
+            done[i] = status != SimStatus::Playing;
+            finalStatus[i] = status;
+            if (done[i])
+                startEpisode(i);
+            observe(i);
+        }
+    }
+
+    /**
+     * @brief Plays one turn in every environment.
+     * @param actions One action per environment.
+     */
+    void step(const SimAction *actions) { stepRange(actions, 0, sessions.size()); }
+
+    /**
+     * @brief Gets the number of environments.
+     */
+    size_t size() const { return sessions.size(); }
+
+    /**
+     * @brief Gets an environment's full game state (e.g. to render or pack it).
+     */
+    const SimSession &session(size_t i) const { return sessions[i]; }
+};
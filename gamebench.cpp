@@ -0,0 +1,295 @@
+// Every heap allocation of the program is counted, so the harness can report allocations per iteration.
+#define DUNGEON_TRACK_ALLOCATIONS
+#include "alloc.h"      // Allocation counts per subsystem
+#include "bench.h"      // Google Benchmark-style harness
+#include "assets.h"     // GameAssetManager
+#include "simulation.h" // Headless rules engine
+
+// The GUI game's classes and turn logic, without SFML (the window, the loop and main are left out).
+#define DUNGEON_HEADLESS
+#include "updatedwithGUI.cpp"
+
+// =================================================================================
+// === Player inventory ============================================================
+// =================================================================================
+
+// Item names as the game passes them: short names, long names, coins (which become coins, not stacks) and a consumable.
+static const char *const inventoryNames[] = {"Armour", "Key1", "Health Booster Potion", "5 Coins", "Key2", "Hourglass", "Key3", "10 Coins"};
+
+// Adds state.range(0) items by name per iteration.
+void benchAddToInventory(BenchState &state)
+{
+    const int64_t items = state.range(0);
+    Player player("Bench");
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < items; ++i)
+            player.addToInventory(inventoryNames[i % 8]);
+        benchDoNotOptimize(player.getInventory().mask());
+    }
+    state.setItemsProcessed(state.iterations() * items);
+}
+BENCHMARK(benchAddToInventory)->range(8, 512);
+
+// An item type with no overload of its own, so it takes addToInventory's generic stringstream path.
+struct LabelledItem
+{
+    const char *label;
+};
+
+ostream &operator<<(ostream &os, const LabelledItem &item) { return os << item.label; }
+
+// Cost of one pickup by argument type: the generic path, std::string, string_view and ItemId.
+template <typename T>
+void benchPickup(BenchState &state)
+{
+    vector<T> pickups;
+    for (const char *name : inventoryNames)
+    {
+        if constexpr (is_same_v<T, ItemId>)
+            pickups.push_back(itemRegistry().intern(name));
+        else
+            pickups.push_back(T{name});
+    }
+    Player player("Bench");
+    for (auto _ : state)
+    {
+        for (const T &item : pickups)
+            player.addToInventory(item);
+        benchDoNotOptimize(player.getInventory().mask());
+    }
+    state.setItemsProcessed(state.iterations() * pickups.size());
+}
+BENCHMARK(benchPickup<LabelledItem>);
+BENCHMARK(benchPickup<string>);
+BENCHMARK(benchPickup<string_view>);
+BENCHMARK(benchPickup<ItemId>);
+
+// A player holding `kinds` different items: the built-in keys and armour first, then extra registered items.
+static void fillInventory(Player &player, int64_t kinds)
+{
+    static const char *const held[] = {"Armour", "Key1", "Key2", "Key3", "Key4", "Key5"};
+    for (int64_t k = 0; k < kinds; ++k)
+        player.addToInventory(k < 6 ? string(held[k]) : "Gem " + to_string(k));
+}
+
+// Reads every stack of an inventory of state.range(0) kinds.
+void benchGetInventory(BenchState &state)
+{
+    Player player("Bench");
+    fillInventory(player, state.range(0));
+    for (auto _ : state)
+    {
+        uint64_t total = 0;
+        player.getInventory().forEachStack([&](ItemId, uint32_t count) { total += count; });
+        benchDoNotOptimize(total);
+    }
+    state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(benchGetInventory)->range(2, 32, 4);
+
+// Sorts an inventory of state.range(0) kinds and lists it, as the end-of-game stats do.
+void benchSortInventory(BenchState &state)
+{
+    Player player("Bench");
+    fillInventory(player, state.range(0));
+    for (auto _ : state)
+    {
+        player.sortInventory();
+        const string listing = describeInventory(player.getInventory());
+        benchDoNotOptimize(listing.size());
+    }
+    state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(benchSortInventory)->range(2, 32, 4);
+
+// =================================================================================
+// === Dungeon =====================================================================
+// =================================================================================
+
+// Builds the five-room campaign with its enemies and loot tables.
+void benchDungeonConstruction(BenchState &state)
+{
+    uint64_t seed = 0;
+    for (auto _ : state)
+    {
+        Dungeon dungeon{Rng(seed++)};
+        benchDoNotOptimize(dungeon.getZobrist());
+    }
+}
+BENCHMARK(benchDungeonConstruction);
+
+// Walks to the last room and backtracks to the first, state.range(0) times per iteration.
+void benchAdvanceBacktrack(BenchState &state)
+{
+    const int64_t sweeps = state.range(0);
+    Dungeon dungeon{Rng(42)};
+    uint64_t steps = 0;
+    for (auto _ : state)
+    {
+        for (int64_t s = 0; s < sweeps; ++s)
+        {
+            for (size_t room = 1; room < builtinCampaign.size(); ++room, ++steps)
+                dungeon.advanceToNextRoom();
+            while (dungeon.backtrack())
+                steps++;
+        }
+        benchDoNotOptimize(dungeon.getZobrist());
+    }
+    state.setItemsProcessed(steps);
+}
+BENCHMARK(benchAdvanceBacktrack)->range(1, 64);
+
+// =================================================================================
+// === Asset manager ===============================================================
+// =================================================================================
+
+// Looks up 1024 scattered assets in a manager holding state.range(0) of them.
+void benchGetAsset(BenchState &state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    GameAssetManager<Treasure> manager;
+    for (size_t i = 0; i < count; ++i)
+        manager.addAsset(make_unique<Treasure>("5 Coins", "Armour", "Key" + to_string(i)));
+
+    Rng rng(42);
+    vector<size_t> lookups(1024);
+    for (size_t &index : lookups)
+        index = rng.nextBelow(static_cast<uint32_t>(count));
+    for (auto _ : state)
+    {
+        uintptr_t sum = 0;
+        for (size_t index : lookups)
+            sum += reinterpret_cast<uintptr_t>(manager.getAsset(index));
+        benchDoNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * lookups.size());
+}
+BENCHMARK(benchGetAsset)->range(8, 4096);
+
+// =================================================================================
+// === Full headless game ==========================================================
+// =================================================================================
+
+// Plays whole games with the headless engine: fights while healthy, sneaks past when hurt, and backtracks on every
+// fifth move (the same player as benchmark.cpp's rule variant benchmarks).
+template <typename Variant>
+void benchHeadlessGame(BenchState &state)
+{
+    const BuiltinCampaignRooms campaign;
+    auto player = [](const SimSession &s, const BuiltinCampaignRooms &) {
+        if (s.player.getMoves() % 5 == 0)
+            return SimAction::Backtrack;
+        return s.player.getHealth() >= 40 ? SimAction::Fight : SimAction::Bypass; };
+
+    uint64_t game = 0;
+    for (auto _ : state)
+    {
+        SimSession session = startSession<Variant>(Rng(streamKey(42, game++)));
+        benchDoNotOptimize(simulateGame<Variant>(session, campaign, player));
+    }
+}
+BENCHMARK(benchHeadlessGame<GuiRules>);
+BENCHMARK(benchHeadlessGame<ConsoleRules>);
+
+// =================================================================================
+// === Steady-state turns ==========================================================
+// =================================================================================
+
+// Plays the GUI game's turns back to back with random actions (timed strikes included), restarting from a snapshot whenever a game ends.
+// After warm-up a turn must not allocate: the run fails if any of its 10^6 turns does.
+void benchSteadyStateTurn(BenchState &state)
+{
+    Player player("Bench");
+    Dungeon dungeon{Rng(42)};
+    string message, gameOverMessage;
+    message.reserve(128); // As the GUI loop does.
+    gameOverMessage.reserve(64);
+    const Room *room = dungeon.enter(); // The GUI loop's first step.
+    const PackedState start = packState(player, dungeon);
+
+    Rng actions(7);
+    const int mix[] = {1, 2, 3, 5}; // Fight, bypass, backtrack and the room's timed strike; quitting (4) is rare.
+    uint64_t games = 0;
+    auto turn = [&] {
+        const int choice = actions.nextBelow(50) == 0 ? 4 : mix[actions.nextBelow(4)];
+        if (playTurn(choice, player, dungeon, room, message, gameOverMessage) == GameState::GAME_OVER)
+        {
+            unpackState(start, player, dungeon);
+            room = dungeon.getCurrentRoom();
+            games++;
+        }
+    };
+    for (int i = 0; i < 1000; ++i) // Warm-up: every message and every room.
+        turn();
+    for (auto _ : state)
+        turn();
+    benchDoNotOptimize(games);
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(benchSteadyStateTurn)->iterations(1000000)->maxAllocations(0);
+
+// Formats the GUI's seven status lines for a mid-game player, as updateStatus does every frame.
+// Names come back by reference and the lines are rebuilt in reused buffers, so a frame must not allocate.
+void benchStatusFrame(BenchState &state)
+{
+    Player player("Bench");
+    fillInventory(player, 6);
+    player.addToInventory("Health Booster Potion");
+    Dungeon dungeon{Rng(42)};
+    const Room *room = dungeon.enter();
+    array<string, statusLineCount> lines;
+    formatStatusLines(player, room, lines); // Warm-up: sizes the buffers.
+    for (auto _ : state)
+    {
+        formatStatusLines(player, room, lines);
+        benchDoNotOptimize(lines[6].size());
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(benchStatusFrame)->maxAllocations(0);
+
+// =================================================================================
+// === Logging =====================================================================
+// =================================================================================
+
+// A call site that has used up its rate limit, as Dungeon's error paths would be if they fired every frame.
+void benchLogSuppressed(BenchState &state)
+{
+    Logger log;
+    log.setSink(nullptr); // Nothing reaches a sink: only the first record is admitted.
+    LogSite site("gamebench.cpp", 1, 1000000);
+    for (auto _ : state)
+        log.log(site, LogLevel::Error, "bench", "Asset index out of bounds.");
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(benchLogSuppressed)->maxAllocations(0);
+
+// Admitted records: copied into the ring and written in batches to /dev/null every 512 records.
+void benchLogRecord(BenchState &state)
+{
+    std::FILE *devNull = std::fopen("/dev/null", "w");
+    if (!devNull)
+        throw runtime_error("Cannot open /dev/null.");
+    {
+        Logger log;
+        log.setSink(devNull);
+        LogSite site("gamebench.cpp", UINT32_MAX);
+        uint64_t records = 0;
+        for (auto _ : state)
+        {
+            log.log(site, LogLevel::Error, "bench", "Asset index out of bounds.");
+            if (++records % 512 == 0)
+                log.flush();
+        }
+        log.flush();
+        state.setItemsProcessed(state.iterations());
+    }
+    std::fclose(devNull);
+}
+BENCHMARK(benchLogRecord);
+
+int main(int argc, char *argv[])
+{
+    return runBenchmarks(argc, argv);
+}
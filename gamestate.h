@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <stdexcept> // Required for std::out_of_range, std::length_error
+
+#include "random.h"     // mix64 (state hashing)
+#include "items.h"      // Inventory
+#include "simulation.h" // SimSession, SimStatus
+#include "zobrist.h"    // Zobrist keys
+#include "platform.h"   // countTrailingZeros
+
+/**
+ * @brief Canonical, bit-packed snapshot of everything the rules depend on: three machine words (24 bytes).
+ * - scalars: health, moves, defense, coins, enemies defeated, room, history depth and status;
+ * - items: the inventory as a presence bitset (bit i = ItemId i held);
+ * - rooms: the backtracking history, 3 bits per room, oldest entry in the lowest bits.
+ * Trivially copyable and compared or hashed word by word, so search, snapshots and replays can hold millions.
+ * Not included: stack sizes beyond one (an item's effect is already folded into the stats when it is picked up),
+ * pending effects (always empty between turns) and the random stream (replays keep the seed instead).
+ */
+class PackedState
+{
+public:
+    static constexpr int maxRooms = 7;    // Room indices 0-7 fit in 3 bits; 7 can only mean "escaped".
+    static constexpr int maxHistory = 21; // 21 history entries of 3 bits fill 63 bits.
+
+private:
+    // Bit layout of the scalars word: offset and width of each field.
+    static constexpr unsigned healthAt = 0, healthBits = 7;
+    static constexpr unsigned movesAt = 7, movesBits = 8;
+    static constexpr unsigned defenseAt = 15, defenseBits = 8;
+    static constexpr unsigned coinsAt = 23, coinsBits = 16;
+    static constexpr unsigned defeatedAt = 39, defeatedBits = 8;
+    static constexpr unsigned roomAt = 47, roomBits = 3;
+    static constexpr unsigned depthAt = 50, depthBits = 5;
+    static constexpr unsigned statusAt = 55, statusBits = 3;
+    static constexpr unsigned historyBits = 3;
+
+    uint64_t scalars = 0;
+    uint64_t items = 0;
+    uint64_t rooms = 0;
+
+    constexpr int field(unsigned at, unsigned bits) const { return static_cast<int>((scalars >> at) & ((1ULL << bits) - 1)); }
+
+    /**
+     * @throws out_of_range If the value does not fit in the field.
+     */
+    constexpr void setField(unsigned at, unsigned bits, int value)
+    {
+        const uint64_t mask = (1ULL << bits) - 1;
+        if (value < 0 || static_cast<uint64_t>(value) > mask)
+            throw std::out_of_range("Value does not fit in the packed game state.");
+        scalars = (scalars & ~(mask << at)) | (static_cast<uint64_t>(value) << at);
+    }
+
+public:
+    constexpr int health() const { return field(healthAt, healthBits); }
+    constexpr int moves() const { return field(movesAt, movesBits); }
+    constexpr int defense() const { return field(defenseAt, defenseBits); }
+    constexpr int coins() const { return field(coinsAt, coinsBits); }
+    constexpr int enemiesDefeated() const { return field(defeatedAt, defeatedBits); }
+    constexpr int roomIndex() const { return field(roomAt, roomBits); }
+    constexpr int historyDepth() const { return field(depthAt, depthBits); }
+    constexpr SimStatus status() const { return static_cast<SimStatus>(field(statusAt, statusBits)); }
+    constexpr uint64_t inventory() const { return items; }
+
+    constexpr void setHealth(int value) { setField(healthAt, healthBits, value); }
+    constexpr void setMoves(int value) { setField(movesAt, movesBits, value); }
+    constexpr void setDefense(int value) { setField(defenseAt, defenseBits, value); }
+    constexpr void setCoins(int value) { setField(coinsAt, coinsBits, value); }
+    constexpr void setEnemiesDefeated(int value) { setField(defeatedAt, defeatedBits, value); }
+    constexpr void setRoomIndex(int value) { setField(roomAt, roomBits, value); }
+    constexpr void setStatus(SimStatus value) { setField(statusAt, statusBits, static_cast<int>(value)); }
+    constexpr void setInventory(uint64_t mask) { items = mask; }
+
+    /**
+     * @brief Gets an entry of the history; entry 0 is the oldest.
+     */
+    constexpr int historyAt(int i) const { return static_cast<int>((rooms >> (historyBits * i)) & 7); }
+
+    /**
+     * @brief Pushes a room onto the history.
+     * @throws length_error If the history already holds maxHistory rooms.
+     */
+    constexpr void pushHistory(int room)
+    {
+        const int depth = historyDepth();
+        if (depth >= maxHistory)
+            throw std::length_error("Room history does not fit in the packed game state.");
+        if (room < 0 || room > maxRooms)
+            throw std::out_of_range("Room index does not fit in the packed game state.");
+        rooms |= static_cast<uint64_t>(room) << (historyBits * depth);
+        setField(depthAt, depthBits, depth + 1);
+    }
+
+    /**
+     * @brief Removes the newest history entry, if there is one.
+     */
+    constexpr void popHistory()
+    {
+        const int depth = historyDepth();
+        if (depth == 0)
+            return;
+        rooms &= ~(7ULL << (historyBits * (depth - 1)));
+        setField(depthAt, depthBits, depth - 1);
+    }
+
+    constexpr bool operator==(const PackedState &other) const
+    {
+        return scalars == other.scalars && items == other.items && rooms == other.rooms;
+    }
+    constexpr bool operator!=(const PackedState &other) const { return !(*this == other); }
+
+    /**
+     * @brief Hashes the whole state (a mixed combination of the three words).
+     */
+    uint64_t hash() const { return mix64(scalars ^ mix64(items ^ mix64(rooms))); }
+};
+
+static_assert(sizeof(PackedState) == 24, "PackedState must stay three machine words");
+
+/**
+ * @brief Zobrist hash of the room part of a state: the current room and the history.
+ */
+constexpr uint64_t zobristRooms(const PackedState &state)
+{
+    uint64_t hash = zobristRoom(state.roomIndex());
+    for (int i = 0; i < state.historyDepth(); ++i)
+        hash ^= zobristHistory(i, state.historyAt(i));
+    return hash;
+}
+
+/**
+ * @brief Computes a state's Zobrist hash from scratch. Objects that maintain their hash incrementally
+ * (SimSession, Player + Dungeon) always agree with this.
+ * @param state The state to hash.
+ * @return The hash.
+ */
+inline uint64_t zobristHash(const PackedState &state)
+{
+    return zobristHealth(state.health()) ^ zobristMoves(state.moves()) ^ zobristDefense(state.defense()) ^
+           zobristItems(state.inventory()) ^ zobristRooms(state);
+}
+
+/**
+ * @brief Rebuilds an inventory from a packed presence bitset, one item per held kind.
+ * @param mask Bit i set means ItemId i is held.
+ * @return The inventory.
+ */
+inline Inventory inventoryFromMask(uint64_t mask)
+{
+    Inventory inventory;
+    for (uint64_t bits = mask; bits != 0; bits &= bits - 1)
+        inventory.add(static_cast<ItemId>(countTrailingZeros(bits)));
+    return inventory;
+}
+
+/**
+ * @brief Packs a room position: the current room and the history.
+ * @param position The position to pack.
+ * @param state The state to fill in; its history must be empty.
+ * @throws out_of_range, length_error If the position is outside the packed ranges (see PackedState).
+ */
+inline void packRooms(const RoomPosition &position, PackedState &state)
+{
+    state.setRoomIndex(position.roomIndex);
+    for (int i = 0; i < position.historyDepth; ++i)
+        state.pushHistory(position.history[i]);
+}
+
+/**
+ * @brief Restores a room position from a packed state.
+ * @param state The packed state.
+ * @param position The position to overwrite.
+ */
+inline void unpackRooms(const PackedState &state, RoomPosition &position)
+{
+    position.roomIndex = state.roomIndex();
+    position.historyDepth = state.historyDepth();
+    for (int i = 0; i < position.historyDepth; ++i)
+        position.history[i] = static_cast<uint8_t>(state.historyAt(i));
+    position.roomZobrist = zobristRooms(state);
+}
+
+/**
+ * @brief Packs a simulated session.
+ * @param session The session to pack.
+ * @return The packed state.
+ * @throws out_of_range, length_error If a value is outside the packed ranges (see PackedState).
+ */
+inline PackedState packState(const SimSession &session)
+{
+    const SimPlayer &player = session.player;
+    PackedState state;
+    state.setHealth(player.getHealth());
+    state.setMoves(player.getMoves());
+    state.setDefense(player.getDefense());
+    state.setCoins(player.getCoins());
+    state.setEnemiesDefeated(player.getEnemiesDefeated());
+    state.setStatus(session.status);
+    state.setInventory(player.getInventory().mask());
+    packRooms(session, state);
+    return state;
+}
+
+/**
+ * @brief Restores a simulated session from a packed state. The session keeps its random stream.
+ * @param state The packed state.
+ * @param session The session to overwrite.
+ */
+inline void unpackState(const PackedState &state, SimSession &session)
+{
+    session.player.restore(state.health(), state.defense(), state.moves(), state.coins(), state.enemiesDefeated(),
+                           inventoryFromMask(state.inventory()));
+    unpackRooms(state, session);
+    session.status = state.status();
+}
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <cstdint>       // Required for fixed-width integer types
+#include <cstddef>       // Required for size_t
+#include <string>        // Required for item names
+#include <string_view>   // Required for the constexpr built-in item table
+#include <vector>        // Required for std::vector (registry storage)
+#include <array>         // Required for std::array (fixed-size stack counts)
+#include <unordered_map> // Required for name lookup
+#include <algorithm>     // Required for std::sort, std::transform
+#include <cctype>        // Required for tolower
+#include <charconv>      // Required for std::to_chars (stack counts)
+#include <stdexcept>     // Required for std::length_error, std::out_of_range
+
+#include "effects.h"  // Effect (what an item does when picked up)
+#include "platform.h" // countTrailingZeros
+
+/**
+ * @brief The broad category of an item, which decides what picking it up does.
+ */
+enum class ItemKind : uint8_t
+{
+    Currency,   // Converted to coins on pickup; never stored as an item.
+    Consumable, // Used up for its effect on pickup (e.g. potions); never stored.
+    Key,        // Opens something; kept in the inventory.
+    Armour,     // Worn protection.
+    Misc        // Anything registered on the fly from an unknown name.
+};
+
+using ItemId = uint16_t; // Index of an item in the registry.
+
+// The registry and every inventory hold at most this many item kinds, so an inventory is a fixed-size array.
+const size_t maxItemKinds = 64;
+
+/**
+ * @brief Static description of one kind of item.
+ */
+struct ItemDef
+{
+    std::string name; // Display name, also the lookup key.
+    ItemKind kind;    // What the item is.
+    int value;        // Coins for currency; otherwise free for the item's own use.
+    Effect effect;    // Queued on the picker when the item is picked up.
+};
+
+/**
+ * @brief Compile-time description of a built-in item.
+ */
+struct BuiltinItem
+{
+    std::string_view name;
+    ItemKind kind;
+    int value;
+    Effect effect;
+};
+
+/**
+ * @brief The built-in items. itemRegistry() registers them first and in this order, so a built-in item's
+ * ItemId is its index here and can be computed at compile time with builtinItemId().
+ */
+inline constexpr BuiltinItem builtinItems[] = {
+    {"5 Coins", ItemKind::Currency, 5, {}},
+    {"10 Coins", ItemKind::Currency, 10, {}},
+    {"Armour", ItemKind::Armour, 0, {EffectKind::DamageReduction, 3}},
+    {"Health Booster Potion", ItemKind::Consumable, 0, {EffectKind::Heal, 25}},
+    {"Hourglass", ItemKind::Consumable, 0, {EffectKind::ExtraMoves, 2}},
+    {"Key1", ItemKind::Key, 0, {}},
+    {"Key2", ItemKind::Key, 0, {}},
+    {"Key3", ItemKind::Key, 0, {}},
+    {"Key4", ItemKind::Key, 0, {}},
+    {"Key5", ItemKind::Key, 0, {}},
+};
+
+const size_t builtinItemCount = sizeof(builtinItems) / sizeof(builtinItems[0]);
+
+/**
+ * @brief Finds the ItemId of a built-in item. In a constant expression an unknown name is a compile error.
+ * @param name The item's display name.
+ * @return The item's ID.
+ * @throws out_of_range If no built-in item has that name (at run time).
+ */
+constexpr ItemId builtinItemId(std::string_view name)
+{
+    for (size_t i = 0; i < builtinItemCount; ++i)
+    {
+        if (builtinItems[i].name == name)
+            return static_cast<ItemId>(i);
+    }
+    throw std::out_of_range("Not a built-in item.");
+}
+
+/**
+ * @brief Registry of every item kind in the game, mapping names to small integer IDs.
+ * Items are interned once (when the dungeon loads or the first time a name is seen); afterwards the game
+ * passes ItemIds around instead of strings.
+ */
+class ItemRegistry
+{
+private:
+    std::vector<ItemDef> items;                     // Definitions indexed by ItemId.
+    std::unordered_map<std::string, ItemId> byName; // Name -> ItemId.
+
+public:
+    /**
+     * @brief Constructor for the ItemRegistry class.
+     * Reserves every slot up front, so registering an item never moves the others and get() references stay valid.
+     */
+    ItemRegistry() { items.reserve(maxItemKinds); }
+
+    /**
+     * @brief Registers a new item kind, or returns the existing ID if the name is already known.
+     * @param name The item's display name.
+     * @param kind The item's category.
+     * @param value Coins for currency items.
+     * @param effect What the item does when picked up.
+     * @return The item's ID.
+     * @throws length_error If the registry already holds maxItemKinds items.
+     */
+    ItemId add(const std::string &name, ItemKind kind, int value = 0, Effect effect = {})
+    {
+        auto found = byName.find(name);
+        if (found != byName.end())
+            return found->second;
+        if (items.size() >= maxItemKinds)
+            throw std::length_error("Item registry is full.");
+        ItemId id = static_cast<ItemId>(items.size());
+        items.push_back({name, kind, value, effect});
+        byName.emplace(name, id);
+        return id;
+    }
+
+    /**
+     * @brief Looks up an item by name, registering unknown names as Misc items.
+     * Known names are found by scanning the (at most maxItemKinds) definitions, so no key string is built and
+     * only the first sighting of a new name allocates.
+     * Not thread-safe when it registers; intern names before starting parallel simulations.
+     * @param name The item's display name.
+     * @return The item's ID.
+     */
+    ItemId intern(std::string_view name)
+    {
+        for (size_t id = 0; id < items.size(); ++id)
+        {
+            if (items[id].name == name)
+                return static_cast<ItemId>(id);
+        }
+        return add(std::string(name), ItemKind::Misc);
+    }
+
+    /**
+     * @brief Looks up a registered item by name.
+     * @param name The item's display name.
+     * @return The item's ID.
+     * @throws out_of_range If no item has that name.
+     */
+    ItemId find(const std::string &name) const
+    {
+        auto found = byName.find(name);
+        if (found == byName.end())
+            throw std::out_of_range("Unknown item: " + name);
+        return found->second;
+    }
+
+    /**
+     * @brief Gets the definition of an item.
+     * @param id The item's ID.
+     * @return A constant reference to the definition.
+     */
+    const ItemDef &get(ItemId id) const { return items[id]; }
+
+    /**
+     * @brief Gets the number of registered item kinds.
+     */
+    size_t size() const { return items.size(); }
+};
+
+/**
+ * @brief The process-wide item registry, pre-filled with the built-in campaign's items.
+ * @return A reference to the registry.
+ */
+inline ItemRegistry &itemRegistry()
+{
+    static ItemRegistry registry = []
+    {
+        ItemRegistry r;
+        for (const BuiltinItem &item : builtinItems)
+            r.add(std::string(item.name), item.kind, item.value, item.effect);
+        return r;
+    }();
+    return registry;
+}
+
+/**
+ * @brief Gets the kind, value and effect of an item without touching the registry for built-in items.
+ * Lets headless code that only uses built-in items run without the registry's allocations.
+ * @param id The item's ID.
+ * @return The item's kind, value and effect (name points at the registry's or the table's text).
+ */
+inline BuiltinItem itemInfo(ItemId id)
+{
+    if (id < builtinItemCount)
+        return builtinItems[id];
+    const ItemDef &def = itemRegistry().get(id);
+    return {def.name, def.kind, def.value, def.effect};
+}
+
+/**
+ * @brief An inventory of counted item stacks (ItemId -> count).
+ * Adding and removing are O(1) array updates and the size never changes, however many items are picked up.
+ */
+class Inventory
+{
+private:
+    std::array<uint32_t, maxItemKinds> counts{}; // Stack size per ItemId.
+    uint64_t present = 0;                        // Bit i is set when counts[i] > 0.
+    bool sortedByName = false;                   // Display stacks alphabetically instead of by ID.
+
+public:
+    /**
+     * @brief Adds items to a stack.
+     * @param id The item's ID.
+     * @param count How many to add.
+     */
+    void add(ItemId id, uint32_t count = 1)
+    {
+        counts[id] += count;
+        if (counts[id] > 0)
+            present |= 1ULL << id;
+    }
+
+    /**
+     * @brief Removes items from a stack.
+     * @param id The item's ID.
+     * @param count How many to remove.
+     * @return True if the stack held at least count items (and they were removed), false otherwise.
+     */
+    bool remove(ItemId id, uint32_t count = 1)
+    {
+        if (counts[id] < count)
+            return false;
+        counts[id] -= count;
+        if (counts[id] == 0)
+            present &= ~(1ULL << id);
+        return true;
+    }
+
+    /**
+     * @brief Gets how many of an item the inventory holds.
+     */
+    uint32_t count(ItemId id) const { return counts[id]; }
+
+    /**
+     * @brief Gets the set of held item kinds as a bitmask (bit i = ItemId i).
+     */
+    uint64_t mask() const { return present; }
+
+    /**
+     * @brief Checks whether the inventory holds no items.
+     */
+    bool empty() const { return present == 0; }
+
+    /**
+     * @brief Makes listings of this inventory alphabetical (case-insensitive) instead of in pickup-kind order.
+     */
+    void sortByName() { sortedByName = true; }
+
+    /**
+     * @brief Checks whether listings are alphabetical.
+     */
+    bool isSortedByName() const { return sortedByName; }
+
+    /**
+     * @brief Calls a function for every non-empty stack, in ItemId order.
+     * @tparam Fn A callable taking (ItemId, uint32_t count).
+     */
+    template <typename Fn>
+    void forEachStack(Fn &&fn) const
+    {
+        for (uint64_t bits = present; bits != 0; bits &= bits - 1)
+        {
+            ItemId id = static_cast<ItemId>(countTrailingZeros(bits));
+            fn(id, counts[id]);
+        }
+    }
+};
+
+/**
+ * @brief Appends an inventory listing such as "Armour x2, Key1" to a string.
+ * Stacks are listed alphabetically if the inventory was sorted, otherwise in ItemId order.
+ * Works on the stack, so it allocates only if the string has to grow (e.g. never for a reused status line).
+ * @param out The string to append to.
+ * @param inventory The inventory to describe.
+ * @param separator Text placed between stacks.
+ */
+inline void appendInventory(std::string &out, const Inventory &inventory, std::string_view separator = ", ")
+{
+    const ItemRegistry &registry = itemRegistry();
+    std::array<ItemId, maxItemKinds> ids;
+    size_t count = 0;
+    inventory.forEachStack([&](ItemId id, uint32_t) { ids[count++] = id; });
+
+    if (inventory.isSortedByName())
+    {
+        // Case-insensitive alphabetical order, as the original list-based sortInventory() produced.
+        auto lower = [](unsigned char c) { return std::tolower(c); };
+        std::sort(ids.begin(), ids.begin() + count, [&](ItemId a, ItemId b) {
+            const std::string &left = registry.get(a).name, &right = registry.get(b).name;
+            return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end(),
+                                                [&](char x, char y) { return lower(x) < lower(y); }); });
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+            out.append(separator);
+        out.append(registry.get(ids[i]).name);
+        if (inventory.count(ids[i]) > 1)
+        {
+            char digits[16];
+            out.append(" x");
+            out.append(digits, std::to_chars(digits, digits + sizeof(digits), inventory.count(ids[i])).ptr);
+        }
+    }
+}
+
+/**
+ * @brief Formats an inventory as a list such as "Armour x2, Key1" (see appendInventory).
+ * @param inventory The inventory to describe.
+ * @param separator Text placed between stacks.
+ * @return The formatted list, or an empty string if the inventory is empty.
+ */
+inline std::string describeInventory(const Inventory &inventory, const std::string &separator = ", ")
+{
+    std::string text;
+    appendInventory(text, inventory, separator);
+    return text;
+}
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <cstdint>            // Required for fixed-width integer types
+#include <cstddef>            // Required for size_t
+#include <cstdio>             // Required for FILE, snprintf and fwrite (the sink)
+#include <cstring>            // Required for std::memcpy (copying details into records)
+#include <array>              // Required for std::array (ring slots)
+#include <atomic>             // Required for std::atomic (lock-free ring, rate limits)
+#include <chrono>             // Required for steady_clock (timestamps, rate-limit windows)
+#include <thread>             // Required for std::thread (asynchronous flushing)
+#include <mutex>              // Required for std::mutex (flusher wake-up, sink writes)
+#include <condition_variable> // Required for std::condition_variable (flusher wake-up)
+#include <string_view>        // Required for std::string_view (record details)
+
+// =================================================================================
+// === Structured logging ==========================================================
+// =================================================================================
+//
+// Logging a record never blocks and never allocates: the record is copied into a fixed-size slot of a lock-free
+// ring buffer and written out later, in batches, by a background flusher (or by an explicit flush()).
+// Each call site is rate-limited on its own, so a message repeated every frame costs two atomic operations once its
+// burst is used up; the next record it lets through says how many were suppressed.
+// Records are written one per line as key=value pairs, e.g.
+//   t=12.503817 level=error site=updatedwithGUI.cpp:648 event=room_lookup_failed detail="..." suppressed=59
+
+/**
+ * @brief Severity of a record. Records below the logger's level are discarded at the call site.
+ */
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off, // As a threshold: log nothing.
+};
+
+/**
+ * @brief Gets a level's name as written in records, e.g. "warn".
+ */
+inline const char *logLevelName(LogLevel level)
+{
+    static const char *const names[] = {"debug", "info", "warn", "error", "off"};
+    return names[static_cast<size_t>(level)];
+}
+
+const size_t maxLogDetail = 192; // Longer details are truncated.
+
+/**
+ * @brief One log record, self-contained so it can sit in the ring until it is written.
+ */
+struct LogRecord
+{
+    uint64_t timeNs = 0;        // Nanoseconds since the logger started.
+    const char *site = "";      // "file:line" of the call site (static storage).
+    const char *event = "";     // Short machine-readable event name (static storage).
+    uint32_t suppressed = 0;    // Records the call site's rate limit dropped since its previous record.
+    LogLevel level = LogLevel::Info;
+    uint16_t detailLength = 0;
+    char detail[maxLogDetail];  // Free-form text, copied (e.g. an exception's what()).
+};
+
+/**
+ * @brief A call site's rate limit: at most `burst` records per window, the rest are counted and dropped.
+ * Declared static at each call site by DUNGEON_LOG, so every site has its own budget.
+ */
+class LogSite
+{
+private:
+    const char *where;
+    uint32_t burst;
+    uint64_t windowNs;
+    std::atomic<uint64_t> windowStart{0};
+    std::atomic<uint32_t> used{0};
+    std::atomic<uint32_t> suppressed{0};
+
+public:
+    /**
+     * @brief Constructor for the LogSite class.
+     * @param site "file:line" of the call site.
+     * @param perWindow Records let through per window.
+     * @param windowMs Length of a window in milliseconds.
+     */
+    constexpr LogSite(const char *site, uint32_t perWindow = 5, uint64_t windowMs = 1000)
+        : where(site), burst(perWindow), windowNs(windowMs * 1000000) {}
+
+    const char *getWhere() const { return where; }
+
+    /**
+     * @brief Decides whether a record may be logged now.
+     * @param now The current time in logger nanoseconds.
+     * @param dropped Set to the number of records suppressed since the last admitted one.
+     * @return True if the record is within the budget.
+     */
+    bool admit(uint64_t now, uint32_t &dropped)
+    {
+        uint64_t start = windowStart.load(std::memory_order_relaxed);
+        if (now - start >= windowNs && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed))
+            used.store(0, std::memory_order_relaxed); // New window; racing threads may overshoot the burst slightly.
+        if (used.fetch_add(1, std::memory_order_relaxed) < burst)
+        {
+            dropped = suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+};
+
+/**
+ * @brief Bounded lock-free multi-producer, multi-consumer queue of records (Vyukov's sequence-numbered ring).
+ * Push fails instead of waiting when the ring is full.
+ * @tparam Capacity Number of slots; a power of two.
+ */
+template <size_t Capacity>
+class LogRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "LogRing capacity must be a power of two.");
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    std::array<Slot, Capacity> slots;
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to write.
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to read.
+
+public:
+    LogRing()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Appends a record.
+     * @return False if the ring is full (the record is not stored).
+     */
+    bool tryPush(const LogRecord &record)
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot &slot = slots[pos & (Capacity - 1)];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (lag == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.record = record;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0)
+                return false; // Full: the reader has not released this slot yet.
+            else
+                pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Removes the oldest record.
+     * @return False if the ring is empty.
+     */
+    bool tryPop(LogRecord &record)
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot &slot = slots[pos & (Capacity - 1)];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (lag == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    record = slot.record;
+                    slot.sequence.store(pos + Capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0)
+                return false; // Empty.
+            else
+                pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * @brief The logger: level filter, ring buffer and sink. Use the process-wide logger() through DUNGEON_LOG.
+ */
+class Logger
+{
+public:
+    static const size_t ringCapacity = 1024;
+
+private:
+    LogRing<ringCapacity> ring;
+    std::atomic<LogLevel> threshold{LogLevel::Warn};
+    std::atomic<uint64_t> overflowed{0}; // Records lost because the ring was full.
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    std::FILE *sink = stderr;
+    std::mutex sinkMutex; // One writer at a time; producers never take it.
+
+    std::thread flusher;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::atomic<bool> urgent{false}; // An error was logged: flush without waiting for the interval.
+
+    // Writes one record as a key=value line; returns its length (0 if it does not fit).
+    static size_t format(const LogRecord &record, char *out, size_t space)
+    {
+        int length = std::snprintf(out, space, "t=%llu.%06llu level=%s site=%s event=%s",
+                                   static_cast<unsigned long long>(record.timeNs / 1000000000),
+                                   static_cast<unsigned long long>(record.timeNs / 1000 % 1000000),
+                                   logLevelName(record.level), record.site, record.event);
+        if (length > 0 && record.detailLength && static_cast<size_t>(length) < space)
+            length += std::snprintf(out + length, space - length, " detail=\"%.*s\"", static_cast<int>(record.detailLength), record.detail);
+        if (length > 0 && record.suppressed && static_cast<size_t>(length) < space)
+            length += std::snprintf(out + length, space - length, " suppressed=%u", record.suppressed);
+        if (length <= 0 || static_cast<size_t>(length) + 1 >= space)
+            return 0;
+        out[length] = '\n';
+        return static_cast<size_t>(length) + 1;
+    }
+
+public:
+    Logger() = default;
+    Logger(const Logger &) = delete;
+    Logger &operator=(const Logger &) = delete;
+
+    ~Logger()
+    {
+        stopAsync();
+        flush();
+    }
+
+    /**
+     * @brief Sets the lowest level that is logged (Warn by default).
+     */
+    void setLevel(LogLevel level) { threshold.store(level, std::memory_order_relaxed); }
+
+    bool enabled(LogLevel level) const { return level >= threshold.load(std::memory_order_relaxed) && level != LogLevel::Off; }
+
+    /**
+     * @brief Sets where flushed records go (stderr by default; nullptr discards them). The file must stay open while
+     * the logger uses it.
+     */
+    void setSink(std::FILE *file)
+    {
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        sink = file;
+    }
+
+    /**
+     * @brief Gets the time in nanoseconds since the logger started.
+     */
+    uint64_t now() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    /**
+     * @brief Logs a record if the call site's rate limit allows it. Never blocks and never allocates.
+     * @param site The call site.
+     * @param level The record's severity (checked against the threshold by the caller, see DUNGEON_LOG).
+     * @param event A short event name, e.g. "room_lookup_failed"; must have static storage.
+     * @param detail Free-form text; copied and truncated to maxLogDetail.
+     */
+    void log(LogSite &site, LogLevel level, const char *event, std::string_view detail = {})
+    {
+        LogRecord record;
+        record.timeNs = now();
+        if (!site.admit(record.timeNs, record.suppressed))
+            return;
+        record.site = site.getWhere();
+        record.event = event;
+        record.level = level;
+        record.detailLength = static_cast<uint16_t>(detail.size() < maxLogDetail ? detail.size() : maxLogDetail);
+        std::memcpy(record.detail, detail.data(), record.detailLength);
+        if (!ring.tryPush(record))
+        {
+            overflowed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (level >= LogLevel::Error)
+        {
+            urgent.store(true, std::memory_order_relaxed);
+            wake.notify_one();
+        }
+    }
+
+    /**
+     * @brief Writes every buffered record to the sink now, in batches of whole lines.
+     * @return The number of records written.
+     */
+    size_t flush()
+    {
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        char batch[8192];
+        size_t used = 0, written = 0;
+        LogRecord record;
+        while (ring.tryPop(record))
+        {
+            if (sizeof(batch) - used < 1024) // Room for one more line.
+            {
+                if (sink)
+                    std::fwrite(batch, 1, used, sink);
+                used = 0;
+            }
+            used += format(record, batch + used, sizeof(batch) - used);
+            written++;
+        }
+        if (const uint64_t lost = overflowed.exchange(0, std::memory_order_relaxed))
+        {
+            const int length = std::snprintf(batch + used, sizeof(batch) - used, "t=%llu level=warn site=log.h event=log_overflow dropped=%llu\n",
+                                             static_cast<unsigned long long>(now() / 1000000000), static_cast<unsigned long long>(lost));
+            if (length > 0)
+                used += static_cast<size_t>(length) < sizeof(batch) - used ? static_cast<size_t>(length) : 0;
+        }
+        if (used && sink)
+        {
+            std::fwrite(batch, 1, used, sink);
+            std::fflush(sink);
+        }
+        return written;
+    }
+
+    /**
+     * @brief Starts a background thread that flushes every `interval`, or at once after an error.
+     * Does nothing if it is already running.
+     */
+    void startAsync(std::chrono::milliseconds interval = std::chrono::milliseconds(100))
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        if (flusher.joinable())
+            return;
+        stopping = false;
+        flusher = std::thread([this, interval] {
+            std::unique_lock<std::mutex> wait(wakeMutex);
+            while (!stopping)
+            {
+                wake.wait_for(wait, interval, [this] { return stopping || urgent.load(std::memory_order_relaxed); });
+                urgent.store(false, std::memory_order_relaxed);
+                wait.unlock();
+                flush();
+                wait.lock();
+            }
+        });
+    }
+
+    /**
+     * @brief Stops the background flusher (after a last flush) and waits for it.
+     */
+    void stopAsync()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            if (!flusher.joinable())
+                return;
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+        flush();
+    }
+};
+
+/**
+ * @brief Gets the process-wide logger.
+ */
+inline Logger &logger()
+{
+    static Logger instance;
+    return instance;
+}
+
+#define DUNGEON_LOG_STRING2(x) #x
+#define DUNGEON_LOG_STRING(x) DUNGEON_LOG_STRING2(x)
+
+/**
+ * Logs through logger() with a rate limit of its own: at most `perWindow` records per `windowMs` from this line.
+ * The detail is not evaluated when the level is filtered out.
+ */
+#define DUNGEON_LOG_LIMITED(level, perWindow, windowMs, event, detail)                                         \
+    do                                                                                                         \
+    {                                                                                                          \
+        static LogSite dungeonLogSite(__FILE__ ":" DUNGEON_LOG_STRING(__LINE__), (perWindow), (windowMs));     \
+        if (logger().enabled(level))                                                                           \
+            logger().log(dungeonLogSite, (level), (event), (detail));                                          \
+    } while (0)
+
+// Logs with the default rate limit of 5 records per second per call site.
+#define DUNGEON_LOG(level, event, detail) DUNGEON_LOG_LIMITED(level, 5, 1000, event, detail)
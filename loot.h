@@ -0,0 +1,280 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <string>    // Required for item names
+#include <vector>    // Required for std::vector (table storage)
+#include <utility>   // Required for std::pair
+#include <stdexcept> // Required for std::invalid_argument
+#include <array>     // Required for std::array (compile-time tables)
+
+#include "random.h" // Rng
+#include "items.h"  // ItemId, itemRegistry
+
+/**
+ * @brief Exact probability that an alias table of n columns picks a column: the share of 32-bit values
+ * that the multiply-shift in sample() maps to it.
+ */
+constexpr double aliasColumnOdds(uint64_t column, uint64_t n)
+{
+    return static_cast<double>((((column + 1) << 32) + n - 1) / n - ((column << 32) + n - 1) / n) / 4294967296.0;
+}
+
+/**
+ * @brief Walker's alias table: samples from a fixed discrete distribution in O(1).
+ * Built once in O(n) with Vose's method; each sample costs one random word, one multiply and one comparison,
+ * no matter how many outcomes the table has.
+ */
+class AliasTable
+{
+private:
+    /**
+     * @brief One column of the table: keep the column's own outcome if the coin is below threshold, else take alias.
+     * Threshold and alias sit side by side so a sample touches a single cache line.
+     */
+    struct Slot
+    {
+        uint32_t threshold; // Probability of keeping this column's outcome, scaled to 2^32.
+        uint32_t alias;     // Outcome used otherwise.
+    };
+
+    std::vector<Slot> slots;
+
+public:
+    AliasTable() = default;
+
+    /**
+     * @brief Constructor for the AliasTable class.
+     * @param weights Relative weights of the outcomes; need not sum to 1.
+     * @throws invalid_argument If there are no weights, a weight is negative, or all weights are zero.
+     */
+    explicit AliasTable(const std::vector<double> &weights)
+    {
+        const size_t n = weights.size();
+        double total = 0.0;
+        for (double w : weights)
+        {
+            if (w < 0.0)
+                throw std::invalid_argument("Loot weights must not be negative.");
+            total += w;
+        }
+        if (n == 0 || total <= 0.0)
+            throw std::invalid_argument("Loot table needs at least one positive weight.");
+
+        // Scale so the average column holds exactly 1, then pair each underfull column with an overfull one.
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i)
+        {
+            scaled[i] = weights[i] * static_cast<double>(n) / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+
+        slots.assign(n, Slot{0xFFFFFFFFu, 0});
+        for (size_t i = 0; i < n; ++i)
+            slots[i].alias = static_cast<uint32_t>(i);
+
+        while (!small.empty() && !large.empty())
+        {
+            const uint32_t less = small.back();
+            small.pop_back();
+            const uint32_t more = large.back();
+            slots[less].threshold = static_cast<uint32_t>(scaled[less] * 4294967296.0);
+            slots[less].alias = more;
+            scaled[more] -= 1.0 - scaled[less];
+            if (scaled[more] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+        // Whatever is left is full up to rounding error; it keeps its own outcome (threshold stays at the maximum).
+    }
+
+    /**
+     * @brief Samples an outcome from 64 caller-provided random bits.
+     * The high half picks the column, the low half is the biased coin.
+     * @param bits 64 random bits.
+     * @return The index of the sampled outcome.
+     */
+    uint32_t sample(uint64_t bits) const
+    {
+        const uint32_t column = static_cast<uint32_t>(((bits >> 32) * slots.size()) >> 32);
+        const Slot &slot = slots[column];
+        // Branch-free select: the coin is random, so a branch would mispredict half the time.
+        const uint32_t keep = 0u - static_cast<uint32_t>(static_cast<uint32_t>(bits) < slot.threshold);
+        return (column & keep) | (slot.alias & ~keep);
+    }
+
+    /**
+     * @brief Samples an outcome using a generator.
+     * @param rng The random stream to draw from.
+     * @return The index of the sampled outcome.
+     */
+    uint32_t sample(Rng &rng) const { return sample(rng.next()); }
+
+    /**
+     * @brief Gets the exact probability of each outcome as sampled (including rounding of the thresholds).
+     */
+    std::vector<double> probabilities() const
+    {
+        std::vector<double> odds(slots.size(), 0.0);
+        for (size_t column = 0; column < slots.size(); ++column)
+        {
+            const double pick = aliasColumnOdds(column, slots.size());
+            const double keep = slots[column].threshold / 4294967296.0;
+            odds[column] += pick * keep;
+            odds[slots[column].alias] += pick * (1.0 - keep);
+        }
+        return odds;
+    }
+
+    /**
+     * @brief Gets the number of outcomes in the table.
+     */
+    size_t size() const { return slots.size(); }
+};
+
+/**
+ * @brief One possible drop of a loot table and its exact probability.
+ */
+struct LootOdds
+{
+    ItemId item;
+    double probability;
+};
+
+/**
+ * @brief A weighted list of item drops for one room tier.
+ * Item names are interned into the item registry when the table is built, so rolling returns an ItemId
+ * and never touches a string.
+ */
+class LootTable
+{
+private:
+    std::vector<ItemId> items; // Possible drops, in the order they were given.
+    AliasTable table;          // Sampler over the drop weights.
+
+public:
+    LootTable() = default;
+
+    /**
+     * @brief Constructor for the LootTable class.
+     * @param drops Pairs of item name and relative weight.
+     * @throws invalid_argument If the weights are not usable (see AliasTable).
+     */
+    explicit LootTable(const std::vector<std::pair<std::string, double>> &drops)
+    {
+        std::vector<double> weights;
+        for (const auto &drop : drops)
+        {
+            items.push_back(itemRegistry().intern(drop.first));
+            weights.push_back(drop.second);
+        }
+        table = AliasTable(weights);
+    }
+
+    /**
+     * @brief Rolls one drop from the table in O(1).
+     * @param rng The random stream to draw from.
+     * @return The ID of the dropped item.
+     */
+    ItemId roll(Rng &rng) const { return items[table.sample(rng)]; }
+
+    /**
+     * @brief Gets every drop with its exact probability, in table order.
+     */
+    std::vector<LootOdds> odds() const
+    {
+        const std::vector<double> probabilities = table.probabilities();
+        std::vector<LootOdds> drops;
+        for (size_t i = 0; i < items.size(); ++i)
+            drops.push_back({items[i], probabilities[i]});
+        return drops;
+    }
+
+    /**
+     * @brief Gets the number of distinct drops in the table.
+     */
+    size_t size() const { return items.size(); }
+};
+
+/**
+ * @brief Alias table with a compile-time number of outcomes, built entirely at compile time.
+ * Used for the built-in campaign's loot, so its tables live in read-only data and cost nothing at startup.
+ * @tparam N The number of outcomes.
+ */
+template <size_t N>
+struct FixedAliasTable
+{
+    std::array<uint32_t, N> threshold{}; // Probability of keeping each column's outcome, scaled to 2^32.
+    std::array<uint32_t, N> alias{};     // Outcome used otherwise.
+
+    /**
+     * @brief Samples an outcome from 64 random bits, exactly like AliasTable::sample.
+     */
+    constexpr uint32_t sample(uint64_t bits) const
+    {
+        const uint32_t column = static_cast<uint32_t>(((bits >> 32) * N) >> 32);
+        const uint32_t keep = 0u - static_cast<uint32_t>(static_cast<uint32_t>(bits) < threshold[column]);
+        return (column & keep) | (alias[column] & ~keep);
+    }
+
+    /**
+     * @brief Gets the exact probability of each outcome as sampled, like AliasTable::probabilities.
+     */
+    constexpr std::array<double, N> probabilities() const
+    {
+        std::array<double, N> odds{};
+        for (size_t column = 0; column < N; ++column)
+        {
+            const double pick = aliasColumnOdds(column, N);
+            const double keep = threshold[column] / 4294967296.0;
+            odds[column] += pick * keep;
+            odds[alias[column]] += pick * (1.0 - keep);
+        }
+        return odds;
+    }
+};
+
+/**
+ * @brief Builds a FixedAliasTable with Vose's method (the same algorithm as AliasTable's constructor).
+ * @param weights Relative weights of the outcomes; must contain a positive weight.
+ * @return The finished table.
+ */
+template <size_t N>
+constexpr FixedAliasTable<N> makeFixedAliasTable(const std::array<double, N> &weights)
+{
+    double total = 0.0;
+    for (double w : weights)
+        total += w;
+
+    FixedAliasTable<N> table{};
+    std::array<double, N> scaled{};
+    std::array<uint32_t, N> small{}, large{};
+    size_t smallCount = 0, largeCount = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        scaled[i] = weights[i] * static_cast<double>(N) / total;
+        table.threshold[i] = 0xFFFFFFFFu;
+        table.alias[i] = static_cast<uint32_t>(i);
+        if (scaled[i] < 1.0)
+            small[smallCount++] = static_cast<uint32_t>(i);
+        else
+            large[largeCount++] = static_cast<uint32_t>(i);
+    }
+    while (smallCount > 0 && largeCount > 0)
+    {
+        const uint32_t less = small[--smallCount];
+        const uint32_t more = large[largeCount - 1];
+        table.threshold[less] = static_cast<uint32_t>(scaled[less] * 4294967296.0);
+        table.alias[less] = more;
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0)
+        {
+            --largeCount;
+            small[smallCount++] = more;
+        }
+    }
+    return table;
+}
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <cmath>     // Required for std::fabs (convergence check)
+#include <vector>    // Required for std::vector (states and sparse matrix)
+#include <array>     // Required for std::array (absorption probabilities)
+#include <algorithm> // Required for std::sort, std::max
+#include <stdexcept> // Required for std::length_error, std::out_of_range
+
+#include "combat.h"     // combatOdds
+#include "loot.h"       // LootOdds
+#include "simulation.h" // SimSession, simulateTurn
+#include "gamestate.h"  // PackedState, packState, unpackState
+
+/**
+ * @brief Limits and accuracy of a Markov chain analysis.
+ */
+struct MarkovConfig
+{
+    size_t maxStates = size_t(1) << 25; // Largest number of live states to enumerate (roughly 4 GB of chain at 32M).
+    double tolerance = 1e-13;           // Stop iterating once no probability moves by more than this in a sweep.
+    int maxSweeps = 10000;              // Give up after this many Gauss-Seidel sweeps.
+};
+
+/**
+ * @brief How a game ends from a given state, as exact probabilities (they sum to 1 up to the solver's tolerance).
+ */
+struct AbsorptionOdds
+{
+    double escaped = 0.0;    // Win.
+    double died = 0.0;       // Health dropped below 20.
+    double outOfMoves = 0.0; // Ran out of moves.
+    double quit = 0.0;       // Chose to quit.
+};
+
+/**
+ * @brief Size of an analyzed chain and how the solver converged.
+ */
+struct MarkovStats
+{
+    size_t states = 0;      // Live (non-terminal) states.
+    size_t transitions = 0; // Non-zero entries between live states.
+    int sweeps = 0;         // Gauss-Seidel sweeps run.
+    double residual = 0.0;  // Largest change in the last sweep.
+};
+
+/**
+ * @brief Packs the starting state of a fresh game with a given health and number of moves, at a rule variant's
+ * opening position (startSession()).
+ * @tparam Variant The rules (GuiRules or ConsoleRules); must match the analyzer's.
+ * @param health The starting health.
+ * @param moves The starting number of moves.
+ * @return The packed state.
+ */
+template <typename Variant = GuiRules>
+PackedState startingState(int health = 100, int moves = builtinRules.startMoves)
+{
+    PackedState state = packState(startSession<Variant>());
+    state.setHealth(health);
+    state.setMoves(moves);
+    return state;
+}
+
+/**
+ * @brief Exact outcome probabilities of the headless rules under a fixed policy, via an absorbing Markov chain.
+ * build() enumerates every live state reachable from the starting states: each state's action comes from the
+ * policy, and every combination of its turn's random events (the fight's distinct results from combatOdds(), then
+ * both loot drops from the rooms' lootOdds()) is played through simulateTurn() itself, so the chain cannot drift
+ * from the rules. Successors are merged into one sparse row per state (compressed sparse rows), and the four
+ * terminal statuses are the absorbing states. solve() finds the absorption probabilities of all states at once
+ * with Gauss-Seidel sweeps in reverse discovery order; most transitions lead to states found later (moves only go
+ * down, except through items), so the sweeps converge in a handful of passes.
+ *
+ * Coins and enemies defeated are zeroed in every state, because no rule reads them; this merges states that have
+ * the same future. A policy must therefore depend only on the other fields (it is called with those fields zeroed).
+ * Memory is about 110 bytes per state plus 12 bytes per transition, so 10^6 states take well under 1 GB.
+ * @tparam Rooms The dungeon's room interface (see simulateTurn).
+ * @tparam Variant The rules (GuiRules or ConsoleRules); start from startingState<Variant>().
+ */
+template <typename Rooms, typename Variant = GuiRules>
+class MarkovAnalyzer
+{
+private:
+    // Replays one branch of a turn's random events and steps to the next branch with nextBranch().
+    struct ScriptedChance
+    {
+        struct Event
+        {
+            uint32_t choice;
+            uint32_t count;
+        };
+
+        const std::vector<std::vector<LootOdds>> *tables; // Drops of each room.
+        std::array<Event, 8> path{}; // Choices of the events seen so far, in turn order.
+        size_t depth = 0;            // Events on the current branch.
+        size_t next = 0;             // Next event to replay.
+        double probability = 1.0;    // Probability of the current branch.
+        CombatOdds combat;
+
+        CombatResult fight(const CombatStats &player, const CombatStats &enemy)
+        {
+            if (next == depth)
+            {
+                combat = combatOdds(player, enemy);
+                path[depth++] = {0, static_cast<uint32_t>(combat.count)};
+            }
+            const CombatOutcome &outcome = combat.outcomes[path[next++].choice];
+            probability *= outcome.probability;
+            return outcome.result;
+        }
+
+        ItemId loot(int room)
+        {
+            const std::vector<LootOdds> &drops = (*tables)[room];
+            if (next == depth)
+                path[depth++] = {0, static_cast<uint32_t>(drops.size())};
+            const LootOdds &drop = drops[path[next++].choice];
+            probability *= drop.probability;
+            return drop.item;
+        }
+
+        // Moves to the next combination of choices; false once every branch has been played.
+        bool nextBranch()
+        {
+            depth = next;
+            while (depth > 0 && ++path[depth - 1].choice == path[depth - 1].count)
+                --depth;
+            next = 0;
+            probability = 1.0;
+            return depth > 0;
+        }
+    };
+
+    // Open-addressing map from packed state to its index in states.
+    class StateIndex
+    {
+    private:
+        static constexpr uint32_t empty = 0xFFFFFFFFu;
+        std::vector<uint32_t> slots;
+        size_t mask = 0;
+
+    public:
+        void clear(size_t capacity)
+        {
+            size_t size = 16;
+            while (size < capacity * 2)
+                size <<= 1;
+            slots.assign(size, empty);
+            mask = size - 1;
+        }
+
+        // Finds a state, inserting it as index `fresh` if it is new; returns its index.
+        uint32_t findOrInsert(const PackedState &key, const std::vector<PackedState> &states, uint32_t fresh)
+        {
+            if ((fresh + 1) * 2 > slots.size())
+            {
+                std::vector<uint32_t> old;
+                old.swap(slots);
+                clear(old.size());
+                for (uint32_t index : old)
+                {
+                    if (index == empty)
+                        continue;
+                    size_t slot = states[index].hash() & mask;
+                    while (slots[slot] != empty)
+                        slot = (slot + 1) & mask;
+                    slots[slot] = index;
+                }
+            }
+            size_t slot = key.hash() & mask;
+            while (slots[slot] != empty)
+            {
+                if (states[slots[slot]] == key)
+                    return slots[slot];
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = fresh;
+            return fresh;
+        }
+
+        // Finds a state; returns empty if it is not known.
+        uint32_t find(const PackedState &key, const std::vector<PackedState> &states) const
+        {
+            if (slots.empty())
+                return empty;
+            size_t slot = key.hash() & mask;
+            while (slots[slot] != empty)
+            {
+                if (states[slots[slot]] == key)
+                    return slots[slot];
+                slot = (slot + 1) & mask;
+            }
+            return empty;
+        }
+    };
+
+    const Rooms *rooms;
+    MarkovConfig config;
+    std::vector<std::vector<LootOdds>> lootOdds; // Per room, read once.
+
+    std::vector<PackedState> states;            // Live states, in discovery order.
+    StateIndex index;
+    std::vector<size_t> rowStart;               // Row i's transitions are [rowStart[i], rowStart[i + 1]).
+    std::vector<uint32_t> target;               // Successor state of each transition.
+    std::vector<double> weight;                 // Probability of each transition.
+    std::vector<std::array<double, 4>> exits;   // Per state: one-turn probability of each terminal status.
+    std::vector<std::array<double, 4>> odds;    // Per state: absorption probabilities (the solution).
+    MarkovStats stats;
+
+    // Terminal statuses in AbsorptionOdds order; Playing maps to -1.
+    static int exitSlot(SimStatus status)
+    {
+        switch (status)
+        {
+        case SimStatus::Escaped:
+            return 0;
+        case SimStatus::Died:
+            return 1;
+        case SimStatus::OutOfMoves:
+            return 2;
+        case SimStatus::Quit:
+            return 3;
+        default:
+            return -1;
+        }
+    }
+
+    static PackedState canonical(PackedState state)
+    {
+        state.setCoins(0);
+        state.setEnemiesDefeated(0);
+        return state;
+    }
+
+    uint32_t intern(const PackedState &state)
+    {
+        const uint32_t fresh = static_cast<uint32_t>(states.size());
+        const uint32_t found = index.findOrInsert(state, states, fresh);
+        if (found == fresh)
+        {
+            if (states.size() >= config.maxStates)
+                throw std::length_error("Markov chain has more states than MarkovConfig::maxStates.");
+            states.push_back(state);
+        }
+        return found;
+    }
+
+public:
+    /**
+     * @brief Constructor for the MarkovAnalyzer class.
+     * @param dungeon The dungeon to analyze; must outlive the analyzer.
+     * @param settings Limits and solver accuracy.
+     */
+    explicit MarkovAnalyzer(const Rooms &dungeon, MarkovConfig settings = {}) : rooms(&dungeon), config(settings)
+    {
+        for (int room = 0; room < dungeon.roomCount(); ++room)
+            lootOdds.push_back(dungeon.lootOdds(room));
+    }
+
+    /**
+     * @brief Enumerates the chain reachable from some starting states. Replaces any previous chain.
+     * @tparam Policy A callable taking (const PackedState&) and returning a SimAction; must be deterministic.
+     * @param starts The starting states (e.g. from startingState()); each must be a live state.
+     * @param policy The decision maker.
+     * @throws length_error, out_of_range If the chain outgrows MarkovConfig::maxStates or a state does not fit a
+     * PackedState.
+     */
+    template <typename Policy>
+    void build(const std::vector<PackedState> &starts, Policy &&policy)
+    {
+        states.clear();
+        index.clear(std::min<size_t>(config.maxStates, 1 << 16));
+        rowStart.assign(1, 0);
+        target.clear();
+        weight.clear();
+        exits.clear();
+        odds.clear();
+        stats = MarkovStats();
+        for (const PackedState &start : starts)
+            intern(canonical(start));
+
+        ScriptedChance chance;
+        chance.tables = &lootOdds;
+        std::vector<std::pair<uint32_t, double>> row; // The current state's successors before merging.
+        SimSession base, session;
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            const PackedState state = states[i];
+            const SimAction action = policy(static_cast<const PackedState &>(state));
+            std::array<double, 4> exit{};
+            row.clear();
+            unpackState(state, base);
+            do
+            {
+                session = base;
+                const SimStatus status = simulateTurn<Variant>(session, *rooms, action, chance);
+                const int slot = exitSlot(status);
+                if (slot >= 0)
+                    exit[slot] += chance.probability;
+                else
+                    row.emplace_back(intern(canonical(packState(session))), chance.probability);
+            } while (chance.nextBranch());
+
+            std::sort(row.begin(), row.end());
+            for (size_t r = 0; r < row.size(); ++r)
+            {
+                if (r > 0 && row[r].first == row[r - 1].first)
+                    weight.back() += row[r].second;
+                else
+                {
+                    target.push_back(row[r].first);
+                    weight.push_back(row[r].second);
+                }
+            }
+            rowStart.push_back(target.size());
+            exits.push_back(exit);
+        }
+        stats.states = states.size();
+        stats.transitions = target.size();
+    }
+
+    /**
+     * @brief Solves the absorbing chain: x = exits + Q x for every terminal status at once (Gauss-Seidel).
+     * @return The chain's size and the solver's convergence.
+     */
+    const MarkovStats &solve()
+    {
+        const size_t n = states.size();
+        odds.assign(n, std::array<double, 4>{});
+        stats.sweeps = 0;
+        do
+        {
+            double change = 0.0;
+            for (size_t i = n; i-- > 0;)
+            {
+                std::array<double, 4> x = exits[i];
+                for (size_t t = rowStart[i]; t < rowStart[i + 1]; ++t)
+                {
+                    const std::array<double, 4> &next = odds[target[t]];
+                    for (int k = 0; k < 4; ++k)
+                        x[k] += weight[t] * next[k];
+                }
+                for (int k = 0; k < 4; ++k)
+                    change = std::max(change, std::fabs(x[k] - odds[i][k]));
+                odds[i] = x;
+            }
+            stats.residual = change;
+            stats.sweeps++;
+        } while (stats.residual > config.tolerance && stats.sweeps < config.maxSweeps);
+        return stats;
+    }
+
+    /**
+     * @brief Gets the exact outcome probabilities from a state of the solved chain (e.g. one of the starts).
+     * @param state The state; coins and enemies defeated are ignored.
+     * @return The absorption probabilities.
+     * @throws out_of_range If the state is not in the chain or solve() has not run.
+     */
+    AbsorptionOdds result(const PackedState &state) const
+    {
+        const uint32_t i = index.find(canonical(state), states);
+        if (i >= odds.size())
+            throw std::out_of_range("State is not part of the solved Markov chain.");
+        return {odds[i][0], odds[i][1], odds[i][2], odds[i][3]};
+    }
+
+    /**
+     * @brief Gets the chain's size and the last solve's convergence.
+     */
+    const MarkovStats &getStats() const { return stats; }
+};
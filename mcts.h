@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <cmath>     // Required for std::log, std::sqrt (UCT)
+#include <vector>    // Required for std::vector (node pool)
+#include <chrono>    // Required for the anytime time budget
+#include <thread>    // Required for std::thread (parallel search and evaluation)
+#include <algorithm> // Required for std::max
+
+#include "random.h"     // Rng, streamKey
+#include "simulation.h" // SimSession, simulateTurn
+
+/**
+ * @brief Tuning of the Monte Carlo tree search.
+ */
+struct MctsConfig
+{
+    double exploration = 0.7;     // UCT exploration constant (rewards are 0 or 1).
+    size_t nodeCapacity = 1 << 16; // Tree nodes allocated up front; when full, leaves stop expanding.
+    int rolloutTurns = 64;        // Safety cap on the length of a random playout.
+};
+
+// The actions the search considers at every node, in choice order (1-4).
+const SimAction mctsActions[] = {SimAction::Fight, SimAction::Bypass, SimAction::Backtrack, SimAction::Quit};
+const int mctsActionCount = 4;
+
+/**
+ * @brief Open-loop Monte Carlo tree search over the headless rules, choosing among the four actions.
+ * The tree is indexed by action sequences; every iteration replays them from the root on a fresh random stream,
+ * so dice and loot are sampled instead of enumerated. A playout scores 1 if the player escapes and 0 otherwise.
+ * The search is anytime: call iterate() or runFor() as often as time allows and read bestAction() whenever needed,
+ * which lets the GUI spread one decision over several frames. No allocation happens after construction.
+ * @tparam Rooms The dungeon's room interface (see simulateTurn).
+ * @tparam Variant The rules searched (GuiRules or ConsoleRules).
+ */
+template <typename Rooms, typename Variant = GuiRules>
+class MctsSearch
+{
+private:
+    struct Node
+    {
+        uint32_t firstChild = 0; // Index of the first of mctsActionCount children; 0 while unexpanded.
+        uint32_t visits = 0;
+        float reward = 0.0f;     // Sum of playout scores through this node.
+    };
+
+    const Rooms *rooms;
+    MctsConfig config;
+    uint64_t seed;
+    SimSession root;
+    std::vector<Node> nodes; // nodes[0] is the root.
+    uint64_t iterations = 0;
+
+    // Picks the child to descend into: an unvisited one first, then the best UCT score.
+    int selectChild(const Node &parent) const
+    {
+        const double logVisits = std::log(static_cast<double>(std::max<uint32_t>(parent.visits, 1)));
+        int best = 0;
+        double bestScore = -1.0;
+        for (int a = 0; a < mctsActionCount; ++a)
+        {
+            const Node &child = nodes[parent.firstChild + a];
+            if (child.visits == 0)
+                return a;
+            const double score = child.reward / child.visits + config.exploration * std::sqrt(logVisits / child.visits);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = a;
+            }
+        }
+        return best;
+    }
+
+public:
+    /**
+     * @brief Constructor for the MctsSearch class.
+     * @param dungeon The dungeon to search; must outlive the search.
+     * @param settings The search settings.
+     * @param streamSeed Seed of the playouts' random streams.
+     */
+    explicit MctsSearch(const Rooms &dungeon, MctsConfig settings = {}, uint64_t streamSeed = 0)
+        : rooms(&dungeon), config(settings), seed(streamSeed)
+    {
+        nodes.reserve(std::max<size_t>(config.nodeCapacity, 1));
+        nodes.emplace_back();
+    }
+
+    /**
+     * @brief Starts a new decision from a position, discarding the previous tree (its memory is kept).
+     * @param position The state to choose an action for.
+     */
+    void reset(const SimSession &position)
+    {
+        root = position;
+        nodes.clear();
+        nodes.emplace_back();
+        iterations = 0;
+    }
+
+    /**
+     * @brief Runs a fixed number of iterations (selection, expansion, playout, backpropagation).
+     * @param count How many iterations to run.
+     */
+    void iterate(uint64_t count)
+    {
+        uint32_t path[128];
+        for (uint64_t n = 0; n < count; ++n)
+        {
+            SimSession session = root;
+            session.rng.reseed(streamKey(seed, iterations++));
+
+            int depth = 0;
+            uint32_t current = 0;
+            path[depth++] = current;
+            while (session.status == SimStatus::Playing && depth < 127)
+            {
+                if (nodes[current].firstChild == 0)
+                {
+                    if (nodes.size() + mctsActionCount > config.nodeCapacity)
+                        break; // Pool full: play out from here.
+                    nodes[current].firstChild = static_cast<uint32_t>(nodes.size());
+                    nodes.resize(nodes.size() + mctsActionCount);
+                }
+                const int action = selectChild(nodes[current]);
+                current = nodes[current].firstChild + action;
+                path[depth++] = current;
+                simulateTurn<Variant>(session, *rooms, mctsActions[action]);
+                if (nodes[current].visits == 0)
+                    break; // Newly reached node: evaluate it with a playout.
+            }
+
+            // Random playout with the three in-game actions (quitting never helps).
+            for (int turn = 0; session.status == SimStatus::Playing && turn < config.rolloutTurns; ++turn)
+                simulateTurn<Variant>(session, *rooms, mctsActions[session.rng.nextBelow(3)]);
+
+            const float score = session.status == SimStatus::Escaped ? 1.0f : 0.0f;
+            for (int i = 0; i < depth; ++i)
+            {
+                nodes[path[i]].visits++;
+                nodes[path[i]].reward += score;
+            }
+        }
+    }
+
+    /**
+     * @brief Iterates until a time budget runs out (the clock is read every few iterations).
+     * @param budget How long to search.
+     */
+    void runFor(std::chrono::steady_clock::duration budget)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        do
+            iterate(16);
+        while (std::chrono::steady_clock::now() < deadline);
+    }
+
+    /**
+     * @brief Gets how often the search tried an action at the root.
+     */
+    uint32_t visits(SimAction action) const
+    {
+        const Node &top = nodes[0];
+        return top.firstChild ? nodes[top.firstChild + static_cast<int>(action) - 1].visits : 0;
+    }
+
+    /**
+     * @brief Gets the estimated chance of escaping after an action (0 if it was never tried).
+     */
+    double value(SimAction action) const
+    {
+        const Node &top = nodes[0];
+        if (!top.firstChild)
+            return 0.0;
+        const Node &child = nodes[top.firstChild + static_cast<int>(action) - 1];
+        return child.visits ? child.reward / child.visits : 0.0;
+    }
+
+    /**
+     * @brief Gets the most-tried action at the root; Fight if the search has not run yet.
+     */
+    SimAction bestAction() const
+    {
+        SimAction best = SimAction::Fight;
+        for (SimAction action : mctsActions)
+        {
+            if (visits(action) > visits(best))
+                best = action;
+        }
+        return best;
+    }
+
+    uint64_t getIterations() const { return iterations; }
+    size_t getNodeCount() const { return nodes.size(); }
+};
+
+/**
+ * @brief Chooses an action with several independent searches on separate threads (root parallelization),
+ * summing their root visit counts. For offline analysis; the GUI uses a single incremental MctsSearch.
+ * @tparam Variant The rules (GuiRules or ConsoleRules).
+ * @tparam Rooms The dungeon's room interface.
+ * @param dungeon The dungeon.
+ * @param position The state to choose an action for.
+ * @param iterationsPerThread Iterations each thread runs.
+ * @param threadCount Number of threads (at least 1).
+ * @param seed Seed of the searches' random streams.
+ * @param config The search settings.
+ * @return The action with the most visits over all threads.
+ */
+template <typename Variant = GuiRules, typename Rooms>
+SimAction mctsChooseParallel(const Rooms &dungeon, const SimSession &position, uint64_t iterationsPerThread,
+                             unsigned threadCount, uint64_t seed, MctsConfig config = {})
+{
+    threadCount = std::max(threadCount, 1u);
+    std::vector<MctsSearch<Rooms, Variant>> searches;
+    searches.reserve(threadCount);
+    for (unsigned t = 0; t < threadCount; ++t)
+        searches.emplace_back(dungeon, config, streamKey(seed, t));
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&searches, &position, iterationsPerThread, t] {
+            searches[t].reset(position);
+            searches[t].iterate(iterationsPerThread);
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    SimAction best = SimAction::Fight;
+    uint64_t bestVisits = 0;
+    for (SimAction action : mctsActions)
+    {
+        uint64_t total = 0;
+        for (const MctsSearch<Rooms, Variant> &search : searches)
+            total += search.visits(action);
+        if (total > bestVisits)
+        {
+            bestVisits = total;
+            best = action;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief A simulateGame() policy that thinks with MCTS for a fixed number of iterations per move.
+ * @tparam Rooms The dungeon's room interface.
+ * @tparam Variant The rules the games are played by.
+ */
+template <typename Rooms, typename Variant = GuiRules>
+class MctsPolicy
+{
+private:
+    MctsSearch<Rooms, Variant> search;
+    uint64_t iterationsPerMove;
+
+public:
+    MctsPolicy(const Rooms &dungeon, uint64_t iterations, uint64_t seed, MctsConfig config = {})
+        : search(dungeon, config, seed), iterationsPerMove(iterations) {}
+
+    SimAction operator()(const SimSession &session, const Rooms &)
+    {
+        search.reset(session);
+        search.iterate(iterationsPerMove);
+        return search.bestAction();
+    }
+};
+
+/**
+ * @brief Offline evaluation: plays many games with the MCTS bot, spread over threads, from the rule variant's
+ * opening position.
+ * @tparam Variant The rules (GuiRules or ConsoleRules).
+ * @tparam Rooms The dungeon's room interface.
+ * @param dungeon The dungeon.
+ * @param games Number of games to play.
+ * @param iterationsPerMove Search iterations per decision.
+ * @param threadCount Number of threads (at least 1).
+ * @param seed Seed of the games' and searches' random streams.
+ * @return The fraction of games in which the bot escaped.
+ */
+template <typename Variant = GuiRules, typename Rooms>
+double mctsEscapeRate(const Rooms &dungeon, uint64_t games, uint64_t iterationsPerMove, unsigned threadCount, uint64_t seed)
+{
+    threadCount = std::max(threadCount, 1u);
+    std::vector<uint64_t> escapes(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t] {
+            MctsPolicy<Rooms, Variant> policy(dungeon, iterationsPerMove, streamKey(seed, 2 * t + 1));
+            for (uint64_t game = t; game < games; game += threadCount)
+            {
+                SimSession session = startSession<Variant>(Rng(streamKey(seed, 2 * game)), dungeon.rules().startMoves);
+                if (simulateGame<Variant>(session, dungeon, policy) == SimStatus::Escaped)
+                    escapes[t]++;
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    uint64_t total = 0;
+    for (uint64_t e : escapes)
+        total += e;
+    return games ? static_cast<double>(total) / static_cast<double>(games) : 0.0;
+}
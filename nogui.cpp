@@ -2,9 +2,9 @@
 
 #include <iostream>
 #include <string>
+#include <string_view> // *** ADDED: Item names passed without copies
 #include <vector>
 #include <queue>
-#include <stack>
 #include <chrono>
 #include <thread>
 #include <memory>      
@@ -12,9 +12,35 @@
 #include <stdexcept>    
 #include <list>        
 #include <limits>       
+#include <cstdlib>      // *** ADDED: strtoull for the seed argument
+#include <cstdio>       // *** ADDED: fwrite/setvbuf for the turn output buffer
+#include <cstring>      // *** ADDED: strcmp for command-line options
+#include <streambuf>    // *** ADDED: TurnOutput replaces cout's buffer
+#include <charconv>     // *** ADDED: from_chars for script choices
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>      // *** ADDED: open for memory-mapped scripts
+#include <sys/mman.h>   // *** ADDED: mmap
+#include <sys/stat.h>   // *** ADDED: fstat (script size)
+#include <unistd.h>     // *** ADDED: close
+#define NOGUI_POSIX 1
+#include "timedinput.h" // *** ADDED: Console input with monotonic deadlines (timed challenges)
+#endif
+
+#include "random.h"     // *** ADDED: Seeded PRNG subsystem
+#include "combat.h"     // *** ADDED: Dice-based combat model
+#include "effects.h"    // *** ADDED: Table-driven item effects
+#include "items.h"      // *** ADDED: Item registry and counted inventory stacks
+#include "loot.h"       // *** ADDED: Alias-method loot tables
+#include "ecs.h"        // *** ADDED: Entity-component storage behind Character
+#include "campaign.h"   // *** ADDED: Compile-time campaign tables (rooms, enemies, loot)
+#include "gamestate.h"  // *** ADDED: Bit-packed game state (snapshots, search, replays)
+#include "zobrist.h"    // *** ADDED: Incremental Zobrist hashes of Player and Dungeon
+#include "alloc.h"      // *** ADDED: Opt-in allocation counts per subsystem (AllocScope)
 
 using namespace std;
 
+using GameRules = ConsoleRules; // *** ADDED: The rule variant (simulation.h) this game plays by
+
 // Forward declarations
 class Player;
 
@@ -22,21 +48,51 @@ class Player;
 // === 1. OOP: ABSTRACT BASE CLASS & POLYMORPHISM ==================================
 // =================================================================================
 // *** ADDED: A pure abstract base class for any character in the game.
+// *** CHANGED: Characters are thin handles; name, health and stats live in ECS component pools.
 class Character {
 protected:
-    string name;
-    int health;
+    World* world; // World that stores this character's components
+    Entity id;    // This character's entity in that world
+
+    int& healthRef() { return world->health.get(id); }
+    StatsComponent& statsRef() { return world->stats.get(id); }
 
 public:
-    Character(string n, int h) : name(n), health(h) {}
-    virtual ~Character() = default; // Virtual destructor for base class
+    Character(const string& n, int h, int atk = 0, int def = 0)
+        : world(&defaultWorld()), id(world->createCharacter(n, h, atk, def)) {}
+    // Copies get their own entity, so characters keep value semantics.
+    Character(const Character& other) : world(other.world), id(world->clone(other.id)) {}
+    Character(Character&& other) noexcept : world(other.world), id(other.id) { other.id = invalidEntity; }
+    Character& operator=(const Character& other) {
+        if (this != &other) {
+            Entity copy = other.world->clone(other.id);
+            if (id != invalidEntity) world->destroy(id);
+            world = other.world;
+            id = copy;
+        }
+        return *this;
+    }
+    Character& operator=(Character&& other) noexcept { // The old entity is released by other's destructor
+        swap(world, other.world);
+        swap(id, other.id);
+        return *this;
+    }
+    virtual ~Character() { // Virtual destructor for base class
+        if (id != invalidEntity) world->destroy(id);
+    }
 
     // *** ADDED: Pure virtual function makes Character an abstract class
     virtual void displayStatus() const = 0;
 
-    string getName() const { return name; }
-    int getHealth() const { return health; }
+    const string& getName() const { return world->nameTable.get(world->names.get(id)); } // *** CHANGED: No copy
+    int getHealth() const { return world->health.get(id); }
+    int getDefense() const { return world->stats.get(id).defense; }
+    CombatStats getCombatStats() const {
+        const StatsComponent& stats = world->stats.get(id);
+        return {getHealth(), stats.attack, stats.defense};
+    }
     void takeDamage(int damage) {
+        int& health = healthRef();
         health -= damage;
         if (health < 0) health = 0;
     }
@@ -46,24 +102,31 @@ public:
 // Class for Player (now inherits from Character)
 class Player : public Character {
 private:
-    list<string> inventory; // *** CHANGED: Using std::list for inventory (Linked List)
+    Inventory inventory; // *** CHANGED: Counted item stacks (ItemId -> count) instead of a list of strings
     int moves;
     int coins;
     int enemiesDefeated;
+    EffectQueue pendingEffects; // *** ADDED: Item effects applied at the end of the turn
+    uint64_t zobrist;           // *** ADDED: Hash of moves, defense and held items, updated by every mutator
 
 public:
     Player(string n);
     void heal(int amount);
-    void addToInventory(string item);
+    void addToInventory(string_view item); // *** CHANGED: Looked up in place, no string copy per pickup
+    void addItem(ItemId item);    // *** ADDED: Currency becomes coins, everything else is stacked
+    bool removeItem(ItemId item); // *** ADDED: Takes one item off its stack
+    void applyPendingEffects();   // *** ADDED: Heal, damage reduction and extra moves from pickups
     void addCoins(int amount);
+    void restore(int health, int defense, int moves, int coins, int enemiesDefeated, const Inventory& items); // *** ADDED: Load a snapshot
     void useMove();
     void incrementEnemiesDefeated();
 
     int getMoves() const;
     int getCoins() const;
     int getEnemiesDefeated() const;
-    list<string> getInventory() const;
+    const Inventory& getInventory() const;
     void sortInventory(); // *** ADDED: Method to demonstrate sorting algorithm
+    uint64_t getZobrist() const; // *** ADDED: Zobrist hash of the player's part of the state
 
     // *** ADDED: Overridden virtual function for Polymorphism
     void displayStatus() const override;
@@ -79,11 +142,11 @@ ostream& operator<<(ostream& os, const Player& player);
 // Class for Enemy (now inherits from Character)
 class Enemy : public Character {
 private:
-    string description;
+    string_view description; // *** CHANGED: Points into builtinCampaign instead of copying the text
 
 public:
-    Enemy(string n, string desc, int hr);
-    string getDescription() const;
+    Enemy(const string& n, string_view desc, int hr);
+    string_view getDescription() const; // *** CHANGED: Getters return views instead of copies
 
     // *** ADDED: Overridden virtual function for Polymorphism
     void displayStatus() const override;
@@ -92,33 +155,36 @@ public:
 // Class for Treasure
 class Treasure {
 private:
-    string item1;
-    string item2;
-    string key;
+    // *** CHANGED: Item names point into builtinCampaign instead of copying the text
+    string_view item1;
+    string_view item2;
+    string_view key;
 
 public:
-    Treasure(string i1, string i2, string k);
-    string getItem1() const;
-    string getItem2() const;
-    string getKey() const;
+    Treasure(string_view i1, string_view i2, string_view k);
+    string_view getItem1() const;
+    string_view getItem2() const;
+    string_view getKey() const;
 };
 
 // Class for Room
 class Room {
 private: // *** CHANGED: Encapsulation - Members are now private
-    string name;
+    string_view name;      // *** CHANGED: Room text points into builtinCampaign, so building a room copies none of it
     Enemy enemy;
     Treasure treasure;
-    string challenge;
+    string_view challenge;
+    int timeLimit; // *** ADDED: Seconds to leave the room once entered (0: untimed)
 
 public:
-    Room(string n, Enemy e, Treasure t, string c);
+    Room(string_view n, Enemy e, Treasure t, string_view c, int timeLimitSeconds = 0);
 
     // *** ADDED: Getters for private members
-    string getName() const;
+    string_view getName() const;
     const Enemy& getEnemy() const;
     const Treasure& getTreasure() const;
-    string getChallenge() const;
+    string_view getChallenge() const;
+    int getTimeLimit() const;
 };
 
 // Class for Dungeon
@@ -126,55 +192,99 @@ class Dungeon {
 private:
     // *** CHANGED: Using smart pointers for automatic memory management (Advanced C++ Feature)
     vector<unique_ptr<Room>> rooms; // A vector of unique pointers to Rooms
-    queue<Enemy> enemyQueue;
-    stack<const Room*> roomStack;  // Stack holds non-owning (raw) pointers
-    int currentRoomIndex;          // *** ADDED: To track the current room
+    queue<const Enemy*> enemyQueue; // *** CHANGED: Non-owning pointers into rooms; no Enemy copies
+    RoomPosition position;         // *** CHANGED: Current room, rooms left behind and their hash, moved by GameRules
+    Rng rng;                       // *** ADDED: Seeded generator for combat, loot and generation
 
 public:
-    Dungeon();
+    Dungeon(Rng generator = Rng());
     // *** CHANGED: Destructor ~Dungeon() is removed. unique_ptr handles memory automatically (Rule of Zero).
+    void reset(Rng generator);           // *** ADDED: Start a new session in the same rooms, without rebuilding them
 
     void displayRules() const;
     const Room* getCurrentRoom() const;    // *** CHANGED: To get current room
     const Room* advanceToNextRoom();     // *** CHANGED: To move to the next room
     const Room* backtrack();             // *** CHANGED: Backtracking logic updated
     void displayRanking(const Player& player) const;
+    Rng& getRng();                       // *** ADDED: The session's random stream
+    const CompiledLoot& getCurrentLootTable() const; // *** ADDED: Drops of the current room's tier
+    void packRooms(PackedState& state) const;     // *** ADDED: Current room and history into a packed state; marks it Escaped past the last room
+    void restoreRooms(const PackedState& state);  // *** ADDED: Current room and history from a packed state
+    uint64_t getZobrist() const;                  // *** ADDED: Zobrist hash of the current room and history
 };
 
-// =================================================================================
-// === 3. ADVANCED C++: TEMPLATES ==================================================
-// =================================================================================
-// A template function to print items from any standard container.
-template<typename T>
-void printContainer(const T& container) {
-    for (const auto& item : container) {
-        cout << item << " ";
-    }
-    cout << endl;
-}
-// =================================================================================
-
 // =================================================================================
 // === Player Class Implementation =================================================
 // =================================================================================
 
-Player::Player(string n) : Character(n, 100), moves(10), coins(0), enemiesDefeated(0) {}
+// *** CHANGED: Starting moves come from builtinRules, shared with the headless engine
+Player::Player(string n) : Character(n, 100), moves(builtinRules.startMoves), coins(0), enemiesDefeated(0),
+                           zobrist(zobristMoves(builtinRules.startMoves) ^ zobristDefense(0)) {}
 
 void Player::heal(int amount) {
+    int& health = healthRef();
     health += amount;
     if (health > 100) health = 100;
 }
 
-void Player::addToInventory(string item) {
-    inventory.push_back(item);
+void Player::addToInventory(string_view item) {
+    AllocScope scope(AllocTag::Player); // *** ADDED: Charge allocations to the player when tracking is on
+    addItem(itemRegistry().intern(item));
+}
+
+void Player::addItem(ItemId item) {
+    AllocScope scope(AllocTag::Player);
+    const ItemDef& def = itemRegistry().get(item);
+    if (def.kind == ItemKind::Currency) {
+        coins += def.value; // Coins are counted once, not also kept as "5 Coins" text
+        return;
+    }
+    pendingEffects.push(def.effect);
+    if (def.kind != ItemKind::Consumable) { // Consumables are used up on pickup
+        uint64_t before = inventory.mask();
+        inventory.add(item);
+        zobrist ^= zobristItems(before ^ inventory.mask());
+    }
+}
+
+void Player::applyPendingEffects() {
+    AllocScope scope(AllocTag::Player);
+    EffectStats stats{getHealth(), getDefense(), moves};
+    pendingEffects.applyAll(stats);
+    zobrist ^= zobristDefense(getDefense()) ^ zobristDefense(stats.defense) ^ zobristMoves(moves) ^ zobristMoves(stats.moves);
+    heal(stats.health - getHealth()); // Healing is the only way effects change health
+    statsRef().defense = stats.defense;
+    moves = stats.moves;
+}
+
+bool Player::removeItem(ItemId item) {
+    uint64_t before = inventory.mask();
+    bool removed = inventory.remove(item);
+    zobrist ^= zobristItems(before ^ inventory.mask());
+    return removed;
 }
 
 void Player::addCoins(int amount) {
     coins += amount;
 }
 
+void Player::restore(int health, int defense, int moves, int coins, int enemiesDefeated, const Inventory& items) {
+    healthRef() = health;
+    statsRef().defense = defense;
+    this->moves = moves;
+    this->coins = coins;
+    this->enemiesDefeated = enemiesDefeated;
+    bool sorted = inventory.isSortedByName();
+    inventory = items;
+    if (sorted) inventory.sortByName();
+    pendingEffects = EffectQueue(); // Snapshots are taken between turns, when nothing is pending
+    zobrist = zobristMoves(moves) ^ zobristDefense(defense) ^ zobristItems(inventory.mask());
+}
+
 void Player::useMove() {
-    moves--;
+    if (spendMove<GameRules::clampMoves>(moves)) { // *** CHANGED: The move rule of GameRules
+        zobrist ^= zobristMoves(moves + 1) ^ zobristMoves(moves);
+    }
 }
 
 void Player::incrementEnemiesDefeated() {
@@ -184,30 +294,30 @@ void Player::incrementEnemiesDefeated() {
 int Player::getMoves() const { return moves; }
 int Player::getCoins() const { return coins; }
 int Player::getEnemiesDefeated() const { return enemiesDefeated; }
-list<string> Player::getInventory() const { return inventory; }
+const Inventory& Player::getInventory() const { return inventory; }
+// Health lives in the ECS world, so it is folded in here instead of tracked.
+uint64_t Player::getZobrist() const { return zobrist ^ zobristHealth(getHealth()); }
 
 // Implementation for sorting the player's inventory (Sorting Algorithm)
 void Player::sortInventory() {
-    inventory.sort(); // Uses the list's built-in sort
+    inventory.sortByName(); // Stacks are listed alphabetically from now on
 }
 
 //  Implementation of the overridden virtual function from Character
 void Player::displayStatus() const {
-    cout << "Player: " << name << " | Health: " << health << endl;
+    cout << "Player: " << getName() << " | Health: " << getHealth() << '\n';
 }
 
 // Implementation of the overloaded << operator
 ostream& operator<<(ostream& os, const Player& player) {
-    os << "\n--- Player Stats ---" << endl;
-    os << "Name: " << player.getName() << endl;
-    os << "Health: " << player.getHealth() << endl;
-    os << "Moves Left: " << player.getMoves() << endl;
-    os << "Coins Collected: " << player.getCoins() << endl;
-    os << "Enemies Defeated: " << player.getEnemiesDefeated() << endl;
-    os << "Inventory (Sorted): ";
-    // *** ADDED: Using the template function to print the inventory
-    printContainer(player.getInventory());
-    os << "--------------------" << endl;
+    os << "\n--- Player Stats ---" << '\n';
+    os << "Name: " << player.getName() << '\n';
+    os << "Health: " << player.getHealth() << '\n';
+    os << "Moves Left: " << player.getMoves() << '\n';
+    os << "Coins Collected: " << player.getCoins() << '\n';
+    os << "Enemies Defeated: " << player.getEnemiesDefeated() << '\n';
+    os << "Inventory (Sorted): " << describeInventory(player.getInventory()) << '\n';
+    os << "--------------------" << '\n';
     return os;
 }
 // =================================================================================
@@ -216,236 +326,643 @@ ostream& operator<<(ostream& os, const Player& player) {
 // === Enemy Class Implementation ==================================================
 // =================================================================================
 // 
-Enemy::Enemy(string n, string desc, int hr) : Character(n, hr), description(desc) {}
+// An enemy's health is both the strength to beat and the damage it deals on defeat.
+Enemy::Enemy(const string& n, string_view desc, int hr) : Character(n, hr, hr), description(desc) {}
 
-string Enemy::getDescription() const { return description; }
+string_view Enemy::getDescription() const { return description; }
 
 // *** ADDED: Implementation of the overridden virtual function from Character
 void Enemy::displayStatus() const {
-    cout << "Enemy: " << name << " | Health Required to Win: " << health << endl;
+    cout << "Enemy: " << getName() << " | Health Required to Win: " << getHealth() << '\n';
 }
 // =================================================================================
 
 // Treasure Class Implementation
-Treasure::Treasure(string i1, string i2, string k) : item1(i1), item2(i2), key(k) {}
-string Treasure::getItem1() const { return item1; }
-string Treasure::getItem2() const { return item2; }
-string Treasure::getKey() const { return key; }
+// *** CHANGED: The text must outlive the treasure; the built-in campaign's lives in read-only data
+Treasure::Treasure(string_view i1, string_view i2, string_view k) : item1(i1), item2(i2), key(k) {}
+string_view Treasure::getItem1() const { return item1; }
+string_view Treasure::getItem2() const { return item2; }
+string_view Treasure::getKey() const { return key; }
 
 // =================================================================================
 // === Room Class Implementation ===================================================
 // =================================================================================
-Room::Room(string n, Enemy e, Treasure t, string c) : name(n), enemy(e), treasure(t), challenge(c) {}
+Room::Room(string_view n, Enemy e, Treasure t, string_view c, int timeLimitSeconds)
+    : name(n), enemy(move(e)), treasure(t), challenge(c), timeLimit(timeLimitSeconds) {}
 
 // getters for encapsulated members
-string Room::getName() const { return name; }
+string_view Room::getName() const { return name; }
 const Enemy& Room::getEnemy() const { return enemy; }
 const Treasure& Room::getTreasure() const { return treasure; }
-string Room::getChallenge() const { return challenge; }
+string_view Room::getChallenge() const { return challenge; }
+int Room::getTimeLimit() const { return timeLimit; }
 // =================================================================================
 
 // =================================================================================
 // === Dungeon Class Implementation ================================================
 // =================================================================================
-Dungeon::Dungeon() : currentRoomIndex(-1) { // Start before the first room
-    // Using std::make_unique for smart pointers (Advanced C++ Feature)
-    rooms.push_back(make_unique<Room>("Base", Enemy("Shadow Stalker", "A stealthy, dark creature.", 15), Treasure("5 Coins", "Armour", "Key1"), "Collect 5 coins"));
-    rooms.push_back(make_unique<Room>("Bronze", Enemy("Viper", "A venomous menace.", 25), Treasure("5 Coins", "Health Booster Potion", "Key2"), "Exit the room within 5 seconds"));
-    rooms.push_back(make_unique<Room>("Platinum", Enemy("Crawler", "A fast, wall-climbing creature.", 35), Treasure("Health Booster Potion", "Armour", "Key3"), "Defeat the enemy without armour"));
-    rooms.push_back(make_unique<Room>("Silver", Enemy("Hunter", "A swift and deadly assassin.", 50), Treasure("5 Coins", "Armour", "Key4"), "Riddle: I have no voice, but I can teach you all I know. What am I? (Answer: book)"));
-    rooms.push_back(make_unique<Room>("Gold", Enemy("Boss", "The ultimate challenge.", 70), Treasure("5 Coins", "Health Booster Potion", "Key5"), "Defeat the boss"));
+Dungeon::Dungeon(Rng generator) : rng(generator) {
+    AllocScope scope(AllocTag::Dungeon); // *** ADDED: Charge allocations to the dungeon when tracking is on
+    // *** CHANGED: Rooms come from the compile-time builtinCampaign table (campaign.h), the single source of truth
+    // shared with the GUI game and the headless engine. They point into its text, and their loot tables were
+    // compiled with it (builtinCampaignLoot), so only the rooms themselves are allocated.
+    rooms.reserve(builtinCampaign.size());
+    for (const RoomDef& def : builtinCampaign) {
+        // Using std::make_unique for smart pointers (Advanced C++ Feature)
+        rooms.push_back(make_unique<Room>(def.name, Enemy(string(def.enemyName), def.enemyDescription, def.enemyHealth),
+                                          Treasure(def.item1, def.item2, def.key), def.challenge, def.timeLimitSeconds));
+    }
 
     for (const auto& room : rooms) {
-        enemyQueue.push(room->getEnemy());
+        enemyQueue.push(&room->getEnemy());
     }
+    GameRules::enter(position); // *** CHANGED: Play starts where GameRules puts it (the first room)
+}
+
+// Rooms, enemies and loot tables never change during a game, so a new session only needs a fresh position and stream.
+void Dungeon::reset(Rng generator) {
+    position = RoomPosition();
+    GameRules::enter(position);
+    rng = generator;
 }
 
 void Dungeon::displayRules() const {
     cout << "Welcome to Dungeon Escape!\n";
     cout << "Rules:\n";
-    cout << "1. You have 10 moves to escape the dungeon.\n";
+    cout << "1. You have " << builtinRules.startMoves << " moves to escape the dungeon.\n";
     cout << "2. Each room has an enemy, a treasure, and a challenge.\n";
     cout << "3. Defeating enemies gets you treasure.\n";
-    cout << "4. If your health drops below 20, you lose.\n";
+    cout << "4. If your health drops below " << builtinRules.minHealth << ", you lose.\n";
     cout << "5. Clear the final room to win.\n";
     cout << "Good luck!\n";
 }
 
 // Function to get the current room using the index
 const Room* Dungeon::getCurrentRoom() const {
-    if (currentRoomIndex >= 0 && currentRoomIndex < rooms.size()) {
-        return rooms[currentRoomIndex].get();
+    if (position.roomIndex < (int)rooms.size()) {
+        return rooms[position.roomIndex].get();
     }
-    return nullptr;
+    return nullptr; // Escaped
 }
 
+// *** CHANGED: The position moves by GameRules, the rule variant the headless engine simulates
 const Room* Dungeon::advanceToNextRoom() {
-    if (currentRoomIndex < (int)rooms.size() - 1) {
-        currentRoomIndex++;
-        const Room* nextRoom = rooms[currentRoomIndex].get();
-        roomStack.push(nextRoom);
-        return nextRoom;
+    if (position.roomIndex < (int)rooms.size()) {
+        advanceRoom(position);
     }
-    return nullptr; // No more rooms
+    return getCurrentRoom(); // nullptr once the player has left the last room
 }
 
 const Room* Dungeon::backtrack() {
-    if (roomStack.size() > 1) {
-        roomStack.pop(); // Pop current room
-        const Room* previousRoom = roomStack.top(); // See what the new top is
-        // Find the index of the previous room
-        for (size_t i = 0; i < rooms.size(); ++i) {
-            if (rooms[i].get() == previousRoom) {
-                currentRoomIndex = i;
-                break;
-            }
-        }
-        return previousRoom;
+    return GameRules::backtrack(position) ? getCurrentRoom() : nullptr; // nullptr if there is no room to go back to
+}
+
+Rng& Dungeon::getRng() { return rng; }
+
+// *** CHANGED: The loot tables are compiled with the campaign (builtinCampaignLoot), so loading builds none
+const CompiledLoot& Dungeon::getCurrentLootTable() const { return builtinCampaignLoot.at(position.roomIndex); }
+
+void Dungeon::packRooms(PackedState& state) const {
+    ::packRooms(position, state);
+    if (position.roomIndex >= (int)rooms.size()) state.setStatus(SimStatus::Escaped); // Leaving the last room ends the game at once
+}
+
+void Dungeon::restoreRooms(const PackedState& state) {
+    if (state.roomIndex() > (int)rooms.size()) { // One past the last room is an escaped game
+        throw out_of_range("Packed state refers to a room outside the dungeon.");
     }
-    return nullptr; // Can't backtrack
+    unpackRooms(state, position);
 }
 
+uint64_t Dungeon::getZobrist() const { return position.roomZobrist; }
+
 // displayRanking uses the overloaded << operator for cleaner code.
 void Dungeon::displayRanking(const Player& player) const {
-    cout << "\n======== GAME OVER ========" << endl;
+    cout << "\n======== GAME OVER ========" << '\n';
     cout << player; // Use the overloaded operator
 }
 
 // =================================================================================
-// === 2. ALGORITHMS: RECURSION ====================================================
+// === Packed game state ===========================================================
 // =================================================================================
-// The main game logic is now a recursive function.
-void gameLoop(Player& player, Dungeon& dungeon) {
-    // Base Cases for recursion: conditions that end the game.
-    if (player.getHealth() < 20) {
-        cout << "\nGame Over! Your health dropped below 20.\n";
-        dungeon.displayRanking(player);
-        return;
+// *** ADDED: Conversions between the game objects and the canonical PackedState (gamestate.h).
+PackedState packState(const Player& player, const Dungeon& dungeon) {
+    PackedState state;
+    state.setHealth(player.getHealth());
+    state.setMoves(player.getMoves());
+    state.setDefense(player.getDefense());
+    state.setCoins(player.getCoins());
+    state.setEnemiesDefeated(player.getEnemiesDefeated());
+    state.setInventory(player.getInventory().mask());
+    dungeon.packRooms(state);
+    if (state.status() == SimStatus::Escaped) return state;
+    if (player.getHealth() < builtinRules.minHealth) state.setStatus(SimStatus::Died); // Same checks, same order, as gameLoop
+    else if (player.getMoves() <= 0) state.setStatus(SimStatus::OutOfMoves);
+    return state;
+}
+
+void unpackState(const PackedState& state, Player& player, Dungeon& dungeon) {
+    player.restore(state.health(), state.defense(), state.moves(), state.coins(), state.enemiesDefeated(),
+                   inventoryFromMask(state.inventory()));
+    dungeon.restoreRooms(state);
+}
+// =================================================================================
+
+// =================================================================================
+// === Game input ==================================================================
+// =================================================================================
+// *** ADDED: The game's answers (name, actions, play again) come from GameInput: the console, or an action script
+// given with --script=FILE. A script is the text one would type, e.g. "Ann 1 1 2 3 4 n", read as whole
+// whitespace-separated words. It is loaded in one go (mmap'd when it is a file, read in 1 MB blocks from a pipe),
+// validated in one pass before the game starts, and then consumed straight from memory without iostreams.
+enum class InputStatus { Ok, Invalid, End, Timeout };
+
+class ScriptInput {
+private:
+    const char* text = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    size_t words = 0;
+    vector<char> owned;     // A script read from a pipe
+    void* mapped = nullptr; // A script mapped from a file
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+    // Rejects binary input (control bytes other than whitespace) with its line, and counts the words.
+    void validate(const string& path) {
+        size_t line = 1;
+        bool inWord = false;
+        for (size_t i = 0; i < size; ++i) {
+            const unsigned char c = static_cast<unsigned char>(text[i]);
+            if (isSpace(static_cast<char>(c))) {
+                line += c == '\n';
+                inWord = false;
+            } else if (c < 0x20 || c == 0x7f) {
+                char byte[8];
+                snprintf(byte, sizeof(byte), "0x%02x", c);
+                throw runtime_error(path + ":" + to_string(line) + ": unexpected control byte " + byte + " (not a text script)");
+            } else {
+                words += !inWord;
+                inWord = true;
+            }
+        }
+        if (words == 0) {
+            throw runtime_error(path + ": script is empty");
+        }
     }
-    if (player.getMoves() <= 0) {
-        cout << "\nGame Over! You ran out of moves.\n";
-        dungeon.displayRanking(player);
-        return;
+
+public:
+    // Loads a script; "-" reads standard input. Throws runtime_error if it cannot be read or is not text.
+    explicit ScriptInput(const string& path) {
+#ifdef NOGUI_POSIX
+        if (path != "-") {
+            int fd = open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+                void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view != MAP_FAILED) {
+                    madvise(view, info.st_size, MADV_SEQUENTIAL);
+                    mapped = view;
+                    text = static_cast<const char*>(view);
+                    size = info.st_size;
+                }
+            }
+            if (fd >= 0) close(fd);
+        }
+#endif
+        if (!text) {
+            FILE* file = path == "-" ? stdin : fopen(path.c_str(), "rb");
+            if (!file) throw runtime_error(path + ": cannot open script");
+            const size_t block = 1 << 20;
+            size_t got;
+            do {
+                owned.resize(size + block);
+                got = fread(owned.data() + size, 1, block, file);
+                size += got;
+            } while (got == block);
+            if (file != stdin) fclose(file);
+            owned.resize(size);
+            text = owned.data();
+        }
+        validate(path);
     }
 
-    const Room* currentRoom = dungeon.getCurrentRoom();
-    if (!currentRoom) { // If the game has just started
-        currentRoom = dungeon.advanceToNextRoom();
-    }
-
-    // Display room and player info
-    cout << "\n----------------------------------------" << endl;
-    cout << "You are in Room: " << currentRoom->getName() << endl;
-    player.displayStatus(); // Using the polymorphic function
-    cout << "Moves Remaining: " << player.getMoves() << endl;
-    cout << "Enemy: " << currentRoom->getEnemy().getName() << " - " << currentRoom->getEnemy().getDescription() << endl;
-    cout << "----------------------------------------" << endl;
-    cout << "Choose your action:\n";
-    cout << "1. Fight enemy\n";
-    cout << "2. Attempt to bypass\n";
-    cout << "3. Backtrack to previous room\n";
-    cout << "4. Quit game\n";
-    cout << "Enter choice: ";
-
-    int choice;
-    cin >> choice;
-
-    // =================================================================================
-    // === 3. ADVANCED C++: EXCEPTION HANDLING =========================================
-    // =================================================================================
-    // simple input validation to handle non-numeric input.
-    if (cin.fail()) {
-        cin.clear(); // Clear error flags
-        cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Discard bad input
-        cout << "\nInvalid input. Please enter a number." << endl;
-        gameLoop(player, dungeon); // Recursive call to try the turn again
-        return;
+    ~ScriptInput() {
+#ifdef NOGUI_POSIX
+        if (mapped) munmap(mapped, size);
+#endif
+    }
+
+    ScriptInput(const ScriptInput&) = delete;
+    ScriptInput& operator=(const ScriptInput&) = delete;
+
+    // Takes the next word; false at the end of the script.
+    bool nextWord(string_view& word) {
+        while (pos < size && isSpace(text[pos])) ++pos;
+        if (pos == size) return false;
+        const size_t start = pos;
+        while (pos < size && !isSpace(text[pos])) ++pos;
+        word = string_view(text + start, pos - start);
+        return true;
+    }
+
+    // Discards the rest of the current line, as the console does after invalid input.
+    void skipLine() {
+        while (pos < size && text[pos] != '\n') ++pos;
+    }
+
+    size_t getWords() const { return words; }
+};
+
+class GameInput {
+private:
+    ScriptInput* script; // nullptr reads the console
+#ifdef NOGUI_POSIX
+    // *** ADDED: Timed console input: stdin watched by an InputMux, so a read can give up at a deadline.
+    unique_ptr<InputMux> mux;
+    int session = -1;
+    vector<MuxEvent> events;
+
+    // Waits for the next console word until the deadline (none if max()).
+    InputStatus nextTimedWord(string_view& word, MonoClock::time_point deadline) {
+        InputReader& reader = mux->reader(session);
+        if (deadline != MonoClock::time_point::max()) mux->setDeadline(session, deadline);
+        InputStatus status = InputStatus::Ok;
+        while (!reader.nextWord(word)) {
+            if (reader.atEnd()) {
+                status = InputStatus::End;
+                break;
+            }
+            cout.flush(); // Show the prompt before waiting
+            mux->wait(events);
+            if (any_of(events.begin(), events.end(), [](const MuxEvent& e) { return e.kind == MuxEventKind::Deadline; })) {
+                return InputStatus::Timeout; // The deadline has been consumed
+            }
+        }
+        mux->clearDeadline(session);
+        return status;
     }
-    // =================================================================================
+#endif
 
-    player.useMove(); // An action costs one move
+public:
+    explicit GameInput(ScriptInput* source = nullptr) : script(source) {}
+
+    // *** ADDED: Reads the console through poll/epoll from now on, so reads can have deadlines.
+    // False if stdin cannot be watched (a regular file, or no POSIX); input then stays untimed.
+    bool enableTimers() {
+#ifdef NOGUI_POSIX
+        try {
+            mux = make_unique<InputMux>();
+            session = mux->add(0);
+            return true;
+        } catch (const runtime_error&) {
+            mux.reset();
+        }
+#endif
+        return false;
+    }
+
+    bool hasTimers() const {
+#ifdef NOGUI_POSIX
+        return mux != nullptr;
+#else
+        return false;
+#endif
+    }
 
-    switch (choice) {
-        case 1: { // Fight
-            const Enemy& enemy = currentRoom->getEnemy();
-            if (player.getHealth() >= enemy.getHealth()) {
-                cout << "\nVictory! You defeated the " << enemy.getName() << ".\n";
-                player.takeDamage(enemy.getHealth());
-                cout << "You collected the treasure!\n";
-                player.addToInventory(currentRoom->getTreasure().getItem1());
-                player.addToInventory(currentRoom->getTreasure().getItem2());
-                player.addCoins(10);
-                player.incrementEnemiesDefeated();
+    // Reads the player's name; false once input has run out.
+    bool readWord(string& word) {
+        string_view next;
+#ifdef NOGUI_POSIX
+        if (mux) {
+            if (nextTimedWord(next, MonoClock::time_point::max()) != InputStatus::Ok) return false;
+            word.assign(next);
+            return true;
+        }
+#endif
+        if (!script) return static_cast<bool>(cin >> word);
+        if (!script->nextWord(next)) return false;
+        word.assign(next);
+        return true;
+    }
 
+    // Reads an action number. A word that is not a number is Invalid and the rest of its line is discarded.
+    // With timers enabled, gives up with Timeout once the deadline passes.
+    InputStatus readChoice(int& choice, chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max()) {
+        string_view word;
+#ifdef NOGUI_POSIX
+        if (mux) {
+            InputStatus status = nextTimedWord(word, deadline);
+            if (status != InputStatus::Ok) return status;
+            if (parseChoice(word, choice)) return InputStatus::Ok;
+            mux->reader(session).skipLine();
+            return InputStatus::Invalid;
+        }
+#endif
+        (void)deadline;
+        if (!script) {
+            if (cin >> choice) return InputStatus::Ok;
+            if (cin.eof()) return InputStatus::End;
+            cin.clear(); // Clear error flags
+            cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Discard bad input
+            return InputStatus::Invalid;
+        }
+        if (!script->nextWord(word)) return InputStatus::End;
+        if (parseChoice(word, choice)) return InputStatus::Ok;
+        script->skipLine();
+        return InputStatus::Invalid;
+    }
+
+    // A whole word as an int, with an optional '+' as cin accepts.
+    static bool parseChoice(string_view word, int& choice) {
+        const char* end = word.data() + word.size();
+        if (word.front() == '+') word.remove_prefix(1);
+        from_chars_result parsed = from_chars(word.data(), end, choice);
+        return parsed.ec == errc() && parsed.ptr == end;
+    }
+
+    // Reads a y/n answer (its first character); 'n' once input has run out.
+    char readAnswer() {
+        string_view word;
+#ifdef NOGUI_POSIX
+        if (mux) return nextTimedWord(word, MonoClock::time_point::max()) == InputStatus::Ok ? word.front() : 'n';
+#endif
+        if (!script) {
+            char answer;
+            return cin >> answer ? answer : 'n';
+        }
+        return script->nextWord(word) ? word.front() : 'n';
+    }
+};
+// =================================================================================
+
+// =================================================================================
+// === 2. GAME LOOP ================================================================
+// =================================================================================
+// *** CHANGED: The game loop was a recursive function, one stack frame per turn and per invalid input; when input
+// ran out, cin failed forever and the recursion overflowed the stack. It is now a plain loop.
+void gameLoop(Player& player, Dungeon& dungeon, GameInput& input) {
+    // *** ADDED: Timed challenges. Entering a room with a time limit starts its clock (monotonic, so changes to the
+    // system time do not matter); each time it runs out before the player acts, the enemy strikes.
+    const Room* timedRoom = nullptr;
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max();
+
+    while (true) {
+        // Conditions that end the game, checked before every turn.
+        if (player.getHealth() < builtinRules.minHealth) { // *** CHANGED: Balance constants from builtinRules
+            cout << "\nGame Over! Your health dropped below " << builtinRules.minHealth << ".\n";
+            dungeon.displayRanking(player);
+            return;
+        }
+        if (player.getMoves() <= 0) {
+            cout << "\nGame Over! You ran out of moves.\n";
+            dungeon.displayRanking(player);
+            return;
+        }
+
+        const Room* currentRoom = dungeon.getCurrentRoom();
+
+        // Display room and player info
+        cout << "\n----------------------------------------" << '\n';
+        cout << "You are in Room: " << currentRoom->getName() << '\n';
+        player.displayStatus(); // Using the polymorphic function
+        cout << "Moves Remaining: " << player.getMoves() << '\n';
+        cout << "Enemy: " << currentRoom->getEnemy().getName() << " - " << currentRoom->getEnemy().getDescription() << '\n';
+        cout << "----------------------------------------" << '\n';
+        if (input.hasTimers() && currentRoom->getTimeLimit() > 0) {
+            if (currentRoom != timedRoom) { // Just entered: start the clock
+                timedRoom = currentRoom;
+                deadline = chrono::steady_clock::now() + chrono::seconds(currentRoom->getTimeLimit());
+            }
+            const auto left = chrono::ceil<chrono::seconds>(deadline - chrono::steady_clock::now()).count();
+            cout << "Challenge: " << currentRoom->getChallenge() << " (" << max<long long>(left, 0) << "s left)\n";
+        } else {
+            timedRoom = nullptr;
+            deadline = chrono::steady_clock::time_point::max();
+        }
+        cout << "Choose your action:\n";
+        cout << "1. Fight enemy\n";
+        cout << "2. Attempt to bypass\n";
+        cout << "3. Backtrack to previous room\n";
+        cout << "4. Quit game\n";
+        cout << "Enter choice: ";
+
+        int choice;
+        InputStatus status = input.readChoice(choice, deadline);
+
+        // =================================================================================
+        // === 3. ADVANCED C++: EXCEPTION HANDLING =========================================
+        // =================================================================================
+        // simple input validation to handle non-numeric input.
+        if (status == InputStatus::Invalid) {
+            cout << "\nInvalid input. Please enter a number." << '\n';
+            continue; // Try the turn again
+        }
+        if (status == InputStatus::End) {
+            choice = 4; // *** ADDED: Running out of input quits the game
+        }
+        if (status == InputStatus::Timeout) { // *** ADDED: Too slow; the turn is lost and the clock starts over
+            cout << "\n\nTime's up! The " << currentRoom->getEnemy().getName() << " strikes while you hesitate.\n";
+            player.useMove();
+            player.takeDamage(builtinRules.timeoutDamage);
+            deadline = chrono::steady_clock::now() + chrono::seconds(currentRoom->getTimeLimit());
+            player.applyPendingEffects();
+            continue;
+        }
+        // =================================================================================
+
+        player.useMove(); // An action costs one move
+
+        switch (choice) {
+            case 1: { // Fight
+                const Enemy& enemy = currentRoom->getEnemy();
+                // *** CHANGED: Dice-based combat instead of a fixed health comparison
+                CombatResult result = resolveCombat(player.getCombatStats(), enemy.getCombatStats(), dungeon.getRng());
+                if (result.playerWon) {
+                    cout << "\nVictory! You defeated the " << enemy.getName() << ".\n";
+                    player.takeDamage(result.winDamage);
+                    cout << "You collected the treasure!\n";
+                    // *** CHANGED: Two weighted drops from the room tier's loot table
+                    const CompiledLoot& loot = dungeon.getCurrentLootTable();
+                    player.addItem(loot.roll(dungeon.getRng()));
+                    player.addItem(loot.roll(dungeon.getRng()));
+                    player.addCoins(builtinRules.winCoins);
+                    player.incrementEnemiesDefeated();
+
+                    const Room* nextRoom = dungeon.advanceToNextRoom();
+                    if (!nextRoom) {
+                        cout << "\nCongratulations! You cleared the final room and escaped the dungeon!\n";
+                        player.sortInventory(); // Sort inventory before final display
+                        dungeon.displayRanking(player);
+                        return; // End game
+                    }
+                } else {
+                    cout << "\nYou were too weak! You flee, taking damage.\n";
+                    player.takeDamage(builtinRules.fleeDamage); // *** CHANGED: The flee penalty of builtinRules
+                }
+                break;
+            }
+            case 2: { // Bypass
+                cout << "\nYou sneak past, avoiding the fight but finding no treasure.\n";
+                player.takeDamage(builtinRules.bypassDamage); // Minor penalty for bypassing
                 const Room* nextRoom = dungeon.advanceToNextRoom();
                 if (!nextRoom) {
-                    cout << "\nCongratulations! You cleared the final room and escaped the dungeon!\n";
-                    player.sortInventory(); // Sort inventory before final display
+                    cout << "\nCongratulations! You snuck out of the final room and escaped!\n";
+                    player.sortInventory();
                     dungeon.displayRanking(player);
                     return; // End game
                 }
-            } else {
-                cout << "\nYou were too weak! You flee, taking damage.\n";
-                player.takeDamage(10);
+                break;
             }
-            break;
-        }
-        case 2: { // Bypass
-            cout << "\nYou sneak past, avoiding the fight but finding no treasure.\n";
-            player.takeDamage(5); // Minor penalty for bypassing
-            const Room* nextRoom = dungeon.advanceToNextRoom();
-            if (!nextRoom) {
-                cout << "\nCongratulations! You snuck out of the final room and escaped!\n";
-                player.sortInventory();
+            case 3: { // Backtrack
+                if (dungeon.backtrack()) {
+                    cout << "\nYou backtrack to the previous room.\n";
+                } else {
+                    cout << "\nThere is no room to backtrack to!\n";
+                }
+                break;
+            }
+            case 4: { // Quit
+                cout << "\nYou have quit the dungeon.\n";
                 dungeon.displayRanking(player);
                 return; // End game
             }
-            break;
+            default:
+                cout << "\nInvalid choice. You hesitate and lose a turn.\n";
+                break;
         }
-        case 3: { // Backtrack
-            if (dungeon.backtrack()) {
-                cout << "\nYou backtrack to the previous room.\n";
-            } else {
-                cout << "\nThere is no room to backtrack to!\n";
-            }
-            break;
+
+        player.applyPendingEffects(); // *** ADDED: Potions, armour and hourglasses act at the end of the turn
+    }
+}
+
+// =================================================================================
+// === Console output ==============================================================
+// =================================================================================
+// *** ADDED: cout used to flush on every endl, a write() per line. Output now collects in one reused buffer:
+//   Turn  (default) written with a single write() whenever the game waits for input (cin is tied to cout), i.e. once
+//         per turn, so prompts still show before each read.
+//   Batch written only when the buffer fills and at exit; for scripted input, where nobody reads the prompts.
+//   Quiet nothing is written at all.
+enum class OutputMode { Turn, Batch, Quiet };
+
+class TurnOutput : public streambuf {
+private:
+    char buffer[1 << 16]; // Far more than a turn prints; only an overflowing turn takes a second write
+    OutputMode mode;
+
+    void writeOut() {
+        if (mode != OutputMode::Quiet && pptr() > pbase()) {
+            fwrite(pbase(), 1, pptr() - pbase(), stdout);
         }
-        case 4: { // Quit
-            cout << "\nYou have quit the dungeon.\n";
-            dungeon.displayRanking(player);
-            return; // End game
+        setp(buffer, buffer + sizeof(buffer));
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        writeOut();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
         }
-        default:
-            cout << "\nInvalid choice. You hesitate and lose a turn.\n";
-            break;
+        return traits_type::not_eof(ch);
     }
 
-    // Recursive call to continue to the next turn
-    gameLoop(player, dungeon);
-}
+    int sync() override {
+        if (mode == OutputMode::Turn) writeOut();
+        return 0;
+    }
+
+public:
+    explicit TurnOutput(OutputMode outputMode) : mode(outputMode) {
+        setvbuf(stdout, nullptr, _IONBF, 0); // Each fwrite goes straight to a single write()
+        setp(buffer, buffer + sizeof(buffer));
+    }
+
+    void finish() { writeOut(); } // Writes whatever is left, in every mode
 
-int main() {
+    ~TurnOutput() override { finish(); }
+};
+// =================================================================================
+
+int main(int argc, char* argv[]) {
     char playAgainChoice = 'y';
 
+    // *** ADDED: Options: --batch writes output in large blocks, --quiet suppresses it, --script=FILE plays the
+    // answers in FILE ("-" for standard input), --timed enforces timed challenges on piped input (POSIX only).
+    // The first other argument is the seed.
+    OutputMode outputMode = OutputMode::Turn;
+    const char* seedArg = nullptr;
+    const char* scriptPath = nullptr;
+#ifdef NOGUI_POSIX
+    bool forceTimers = false;
+#endif
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--batch") == 0) outputMode = OutputMode::Batch;
+        else if (strcmp(argv[i], "--quiet") == 0) outputMode = OutputMode::Quiet;
+        else if (strncmp(argv[i], "--script=", 9) == 0) scriptPath = argv[i] + 9;
+        else if (strcmp(argv[i], "--timed") == 0) {
+#ifdef NOGUI_POSIX
+            forceTimers = true;
+#else
+            cerr << "Timed challenges are not supported on this platform; --timed is ignored.\n";
+#endif
+        }
+        else if (!seedArg) seedArg = argv[i];
+    }
+
+    unique_ptr<ScriptInput> script;
+    if (scriptPath) {
+        try {
+            script = make_unique<ScriptInput>(scriptPath);
+        } catch (const runtime_error& e) {
+            cerr << e.what() << '\n';
+            return 1;
+        }
+    }
+    GameInput input(script.get());
+    // *** ADDED: Timed challenges are enforced when a person plays at a terminal, or with --timed (e.g. a slow pipe).
+    // Scripts and piped sessions stay untimed, so replays are reproducible.
+#ifdef NOGUI_POSIX
+    if (!script && (forceTimers || isatty(0))) {
+        input.enableTimers();
+    }
+#endif
+    ios::sync_with_stdio(false); // cin keeps its own buffer instead of reading through stdio
+
+    TurnOutput output(outputMode);
+    streambuf* consoleBuffer = cout.rdbuf(&output);
+
+    // *** ADDED: Every run is reproducible from its seed (pass it as the first argument to replay).
+    uint64_t seed = seedArg ? strtoull(seedArg, nullptr, 10) : freshSeed();
+    cout << "Seed: " << seed << '\n';
+    RngStreams sessions(seed); // Each play-again session gets its own independent stream
+    Dungeon dungeon; // *** CHANGED: Built once and reset for each session
+
     // *** CHANGED: Replaced recursive main() call with a proper do-while loop
     do {
         string playerName;
         cout << "Enter your name: ";
-        cin >> playerName;
+        if (!input.readWord(playerName)) {
+            cout << '\n';
+            break; // *** ADDED: Input ran out
+        }
 
         Player player(playerName);
-        Dungeon dungeon;
+        dungeon.reset(sessions.next());
 
         dungeon.displayRules();
 
-        // *** CHANGED: Start the game using the new recursive game loop
-        gameLoop(player, dungeon);
+        // *** CHANGED: Start the game loop
+        gameLoop(player, dungeon, input);
 
         cout << "\nPlay again? (y/n): ";
-        cin >> playAgainChoice;
+        playAgainChoice = input.readAnswer();
 
     } while (playAgainChoice == 'y' || playAgainChoice == 'Y');
 
-    cout << "Thanks for playing!" << endl;
+    cout << "Thanks for playing!" << '\n';
+    output.finish();
+    cout.rdbuf(consoleBuffer); // Before output goes out of scope
     return 0;
 }
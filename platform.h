@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint> // Required for fixed-width integer types
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> // Required for _BitScanForward64
+#endif
+
+// Compiler-specific attributes and builtins behind portable names, so every header builds with GCC, Clang and MSVC.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DUNGEON_NOINLINE __attribute__((noinline)) // Keeps a function out of line.
+#define DUNGEON_UNUSED __attribute__((unused))     // Silences the unused-variable warning for a type's objects.
+#elif defined(_MSC_VER)
+#define DUNGEON_NOINLINE __declspec(noinline)
+#define DUNGEON_UNUSED
+#else
+#define DUNGEON_NOINLINE
+#define DUNGEON_UNUSED
+#endif
+
+/**
+ * @brief Counts the zero bits below the lowest set bit.
+ * @param bits The value to scan; must not be 0.
+ * @return The index of the lowest set bit (0-63).
+ */
+inline int countTrailingZeros(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    int count = 0;
+    for (; (bits & 1) == 0; bits >>= 1)
+        ++count;
+    return count;
+#endif
+}
+
+/**
+ * @brief Hints the CPU to start loading a cache line that is about to be read. A no-op where no builtin exists.
+ * @param address Any address inside the line.
+ */
+inline void prefetch(const void *address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstdint> // Required for fixed-width integer types
+#include <limits>  // Required for numeric_limits (UniformRandomBitGenerator bounds)
+#include <random>  // Required for std::random_device (fresh seeds)
+#include <chrono>  // Required for the clock mixed into fresh seeds
+
+/**
+ * @brief Finalizer of the SplitMix64 generator.
+ * Scrambles a 64-bit value so that nearby inputs give unrelated outputs.
+ * @param z The value to scramble.
+ * @return The scrambled value.
+ */
+constexpr uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Advances a SplitMix64 state and returns the next value.
+ * Used to expand a single user seed into the larger xoshiro state.
+ * @param state The SplitMix64 state, advanced in place.
+ * @return The next 64-bit value.
+ */
+constexpr uint64_t splitMix64(uint64_t &state)
+{
+    state += 0x9E3779B97F4A7C15ULL;
+    return mix64(state);
+}
+
+/**
+ * @brief Derives the key of an independent counter-based stream.
+ * The key is computed once per stream (e.g. per simulated session or batch lane).
+ * @param seed The master seed of the run.
+ * @param stream The index of the stream (thread, session, lane, ...).
+ * @return The key to pass to counterRandom().
+ */
+inline uint64_t streamKey(uint64_t seed, uint64_t stream)
+{
+    return mix64(seed ^ mix64(stream + 0x9E3779B97F4A7C15ULL));
+}
+
+/**
+ * @brief Stateless counter-based random value: the same (key, counter) always gives the same bits.
+ * There is no loop-carried state, so loops over many lanes can be vectorized and split across threads freely.
+ * @param key A stream key from streamKey().
+ * @param counter The position within the stream.
+ * @return 64 random bits.
+ */
+inline uint64_t counterRandom(uint64_t key, uint64_t counter)
+{
+    return mix64(key + counter * 0xD1B54A32D192ED03ULL);
+}
+
+/**
+ * @brief 32-bit integer hash (lowbias32) used by the vectorizable counter-based streams.
+ * @param x The value to scramble.
+ * @return The scrambled value.
+ */
+inline uint32_t mix32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    return x ^ (x >> 16);
+}
+
+/**
+ * @brief 32-bit variant of counterRandom() for SIMD loops.
+ * Uses only 32-bit multiplies, which every x86-64 vector unit supports, so batch loops drawing from it vectorize.
+ * @param key A stream key (e.g. the low half of streamKey()).
+ * @param counter The position within the stream.
+ * @return 32 random bits.
+ */
+inline uint32_t counterRandom32(uint32_t key, uint32_t counter)
+{
+    return mix32(key ^ mix32(counter + 0x9E3779B9u));
+}
+
+/**
+ * @brief Produces a new seed for runs where the user did not choose one.
+ * Print it so the run can be reproduced later.
+ * @return A seed mixed from std::random_device and the current time.
+ */
+inline uint64_t freshSeed()
+{
+    std::random_device device;
+    const uint64_t entropy = (static_cast<uint64_t>(device()) << 32) ^ device();
+    return mix64(entropy ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+}
+
+/**
+ * @brief Seeded xoshiro256** pseudo-random generator.
+ * Fast, small (32 bytes) and reproducible across platforms. Independent streams are obtained
+ * with jump(), which advances the generator by 2^128 steps, so streams never overlap in practice.
+ * Satisfies the UniformRandomBitGenerator requirements, so it also works with <random> and std::shuffle.
+ */
+class Rng
+{
+private:
+    uint64_t s[4]; // Generator state; never all zero.
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    using result_type = uint64_t;
+
+    /**
+     * @brief Constructor for the Rng class.
+     * @param seed Any 64-bit seed; equal seeds produce equal sequences.
+     */
+    explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    /**
+     * @brief Resets the generator to the start of the sequence for a seed.
+     * @param seed The new seed.
+     */
+    void reseed(uint64_t seed)
+    {
+        uint64_t sm = seed;
+        for (uint64_t &word : s)
+            word = splitMix64(sm); // SplitMix64 never yields four zero words in a row.
+    }
+
+    /**
+     * @brief Creates the generator for a given stream of a seed.
+     * Stream n is the seed's generator jumped n times. Costs O(n) jumps; hand out many streams with RngStreams instead.
+     * @param seed The master seed.
+     * @param stream The stream index.
+     * @return The generator positioned at the start of the stream.
+     */
+    static Rng forStream(uint64_t seed, uint64_t stream)
+    {
+        Rng rng(seed);
+        for (uint64_t i = 0; i < stream; ++i)
+            rng.jump();
+        return rng;
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /**
+     * @brief Returns the next 64 random bits.
+     */
+    uint64_t next()
+    {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    result_type operator()() { return next(); }
+
+    /**
+     * @brief Returns a uniformly distributed value in [0, bound) without modulo bias (Lemire's method).
+     * @param bound The exclusive upper bound; must be greater than 0.
+     */
+    uint32_t nextBelow(uint32_t bound)
+    {
+        uint64_t product = (next() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound)
+        {
+            const uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) // Rejection is rare: at most bound / 2^32 of draws.
+            {
+                product = (next() >> 32) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    /**
+     * @brief Returns a uniformly distributed integer in [lo, hi].
+     */
+    int nextInt(int lo, int hi)
+    {
+        return lo + static_cast<int>(nextBelow(static_cast<uint32_t>(hi - lo) + 1));
+    }
+
+    /**
+     * @brief Returns a uniformly distributed double in [0, 1).
+     */
+    double nextDouble()
+    {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    /**
+     * @brief Rolls a number of dice and returns their sum (e.g. rollDice(2, 6) for 2d6).
+     */
+    int rollDice(int count, int sides)
+    {
+        int total = 0;
+        for (int i = 0; i < count; ++i)
+            total += 1 + static_cast<int>(nextBelow(static_cast<uint32_t>(sides)));
+        return total;
+    }
+
+    /**
+     * @brief Advances the generator by 2^128 steps.
+     * Calling jump() repeatedly on copies yields non-overlapping streams for threads or sessions.
+     */
+    void jump()
+    {
+        static const uint64_t jumpPoly[] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                            0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (uint64_t poly : jumpPoly)
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                if (poly & (1ULL << b))
+                {
+                    t[0] ^= s[0];
+                    t[1] ^= s[1];
+                    t[2] ^= s[2];
+                    t[3] ^= s[3];
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; ++i)
+            s[i] = t[i];
+    }
+};
+
+/**
+ * @brief Hands out consecutive independent streams of one master seed.
+ * Each call to next() returns a generator and jumps the internal one, so stream k costs one jump, not k.
+ * Give one stream to each thread or game session to keep parallel runs reproducible.
+ */
+class RngStreams
+{
+private:
+    Rng base;            // Generator positioned at the start of the next stream.
+    uint64_t masterSeed; // Seed the streams were derived from.
+    uint64_t issued;     // Number of streams handed out so far.
+
+public:
+    /**
+     * @brief Constructor for the RngStreams class.
+     * @param seed The master seed; stream k of a seed is always the same sequence.
+     */
+    explicit RngStreams(uint64_t seed) : base(seed), masterSeed(seed), issued(0) {}
+
+    /**
+     * @brief Returns the generator for the next stream.
+     */
+    Rng next()
+    {
+        Rng stream = base;
+        base.jump();
+        ++issued;
+        return stream;
+    }
+
+    uint64_t getSeed() const { return masterSeed; }
+    uint64_t getIssued() const { return issued; }
+};
@@ -0,0 +1,554 @@
+#pragma once
+
+#include <cstdint>     // Required for fixed-width integer types
+#include <cstddef>     // Required for size_t
+#include <string_view> // Required for non-owning names
+#include <string>      // Required for loot table item names
+#include <utility>     // Required for std::pair
+#include <vector>      // Required for std::vector (dungeon templates)
+#include <array>       // Required for std::array (room history)
+#include <variant>     // Required for std::variant (AnyCharacter)
+#include <ostream>     // Required for displayStatus output
+#include <type_traits> // Required for std::is_polymorphic
+
+#include "random.h"  // Rng
+#include "combat.h"  // CombatStats, resolveCombat
+#include "effects.h" // EffectQueue, EffectStats
+#include "items.h"   // Inventory, itemRegistry
+#include "loot.h"    // LootTable
+#include "campaign.h" // builtinCampaign, builtinCampaignLoot, RuleSet
+#include "zobrist.h"  // Zobrist keys (incremental state hashes)
+
+// =================================================================================
+// === Compile-time polymorphic characters for the headless engine =================
+// =================================================================================
+
+/**
+ * @brief CRTP base of the simulation characters: the counterpart of Character without virtual functions.
+ * displayStatus() is resolved at compile time through Derived, so calls inline and objects carry no vtable pointer.
+ * @tparam Derived The concrete character type (SimPlayer or SimEnemy).
+ */
+template <typename Derived>
+class SimCharacter
+{
+protected:
+    std::string_view name; // Points at static text (e.g. the campaign tables); never owns memory.
+    int health;
+    int attack;
+    int defense;
+
+public:
+    /**
+     * @brief Constructor for the SimCharacter class.
+     * @param n The name of the character; must outlive the character.
+     * @param h The initial health.
+     * @param atk The attack stat used in combat.
+     * @param def The defense stat used in combat.
+     */
+    constexpr SimCharacter(std::string_view n, int h, int atk = 0, int def = 0) : name(n), health(h), attack(atk), defense(def) {}
+
+    /**
+     * @brief Writes the character's status line; dispatches statically to Derived::writeStatus.
+     * @param os The stream to write to.
+     */
+    void displayStatus(std::ostream &os) const { static_cast<const Derived *>(this)->writeStatus(os); }
+
+    constexpr std::string_view getName() const { return name; }
+    constexpr int getHealth() const { return health; }
+    constexpr int getDefense() const { return defense; }
+    constexpr CombatStats getCombatStats() const { return {health, attack, defense}; }
+
+    /**
+     * @brief Reduces health by a specified amount; health cannot drop below 0.
+     * @param damage The amount of damage to take.
+     */
+    void takeDamage(int damage)
+    {
+        health -= damage;
+        if (health < 0)
+            health = 0;
+    }
+};
+
+/**
+ * @brief Spends one move from a move counter; the move rule of every Player (GUI, console and SimPlayer).
+ * @tparam Clamp Stop at 0 (GuiRules::clampMoves) or keep counting down (ConsoleRules::clampMoves).
+ * @param moves The counter to decrement.
+ * @return True if a move was spent.
+ */
+template <bool Clamp>
+constexpr bool spendMove(int &moves)
+{
+    if (Clamp && moves <= 0)
+        return false;
+    moves--;
+    return true;
+}
+
+/**
+ * @brief Headless counterpart of Player: same rules, plain data, no virtual functions.
+ */
+class SimPlayer : public SimCharacter<SimPlayer>
+{
+private:
+    Inventory inventory;        // Counted item stacks.
+    int moves;                  // Moves remaining.
+    int coins;                  // Coins collected.
+    int enemiesDefeated;        // Enemies defeated.
+    EffectQueue pendingEffects; // Item effects applied at the end of the turn.
+    uint64_t zobrist;           // Zobrist hash of moves, defense and held items, kept up to date by the mutators.
+
+public:
+    /**
+     * @brief Constructor for the SimPlayer class. Starts with 100 health and, by default, the same moves as Player.
+     * @param n The name of the player.
+     * @param startMoves The moves to start with.
+     */
+    explicit SimPlayer(std::string_view n = "Bot", int startMoves = builtinRules.startMoves)
+        : SimCharacter(n, 100), moves(startMoves), coins(0), enemiesDefeated(0),
+          zobrist(zobristMoves(startMoves) ^ zobristDefense(0)) {}
+
+    void heal(int amount)
+    {
+        health += amount;
+        if (health > 100)
+            health = 100;
+    }
+
+    /**
+     * @brief Adds one item by ID, with the same rules as Player::addItem.
+     */
+    void addItem(ItemId item)
+    {
+        const BuiltinItem def = itemInfo(item); // Built-in items never touch the registry.
+        if (def.kind == ItemKind::Currency)
+        {
+            coins += def.value;
+            return;
+        }
+        pendingEffects.push(def.effect);
+        if (def.kind != ItemKind::Consumable)
+        {
+            const uint64_t before = inventory.mask();
+            inventory.add(item);
+            zobrist ^= zobristItems(before ^ inventory.mask());
+        }
+    }
+
+    void applyPendingEffects()
+    {
+        EffectStats stats{health, defense, moves};
+        pendingEffects.applyAll(stats);
+        zobrist ^= zobristDefense(defense) ^ zobristDefense(stats.defense) ^ zobristMoves(moves) ^ zobristMoves(stats.moves);
+        heal(stats.health - health); // Healing is the only way effects change health.
+        defense = stats.defense;
+        moves = stats.moves;
+    }
+
+    void addCoins(int amount) { coins += amount; }
+
+    /**
+     * @brief Overwrites the player's progress, e.g. from a packed snapshot. Pending effects are dropped.
+     */
+    void restore(int h, int def, int mv, int c, int defeated, const Inventory &items)
+    {
+        health = h;
+        defense = def;
+        moves = mv;
+        coins = c;
+        enemiesDefeated = defeated;
+        inventory = items;
+        pendingEffects = EffectQueue();
+        zobrist = zobristMoves(moves) ^ zobristDefense(defense) ^ zobristItems(inventory.mask());
+    }
+
+    /**
+     * @brief Spends one move.
+     * @tparam Clamp Stop at 0 (GuiRules) or keep counting down (ConsoleRules); see spendMove().
+     */
+    template <bool Clamp = true>
+    void useMove()
+    {
+        if (spendMove<Clamp>(moves))
+            zobrist ^= zobristMoves(moves + 1) ^ zobristMoves(moves);
+    }
+
+    void incrementEnemiesDefeated() { enemiesDefeated++; }
+
+    int getMoves() const { return moves; }
+    int getCoins() const { return coins; }
+    int getEnemiesDefeated() const { return enemiesDefeated; }
+    const Inventory &getInventory() const { return inventory; }
+
+    /**
+     * @brief Gets the Zobrist hash of the player's part of the state. Health is folded in here rather than tracked,
+     * so it is right however health changed.
+     */
+    uint64_t getZobrist() const { return zobrist ^ zobristHealth(health); }
+
+    void writeStatus(std::ostream &os) const { os << "Player: " << name << " | Health: " << health << "\n"; }
+};
+
+/**
+ * @brief Headless counterpart of Enemy. Its health is the strength to beat and the damage it deals.
+ */
+class SimEnemy : public SimCharacter<SimEnemy>
+{
+private:
+    std::string_view description;
+
+public:
+    /**
+     * @brief Constructor for the SimEnemy class.
+     * @param n The name of the enemy.
+     * @param desc A description of the enemy.
+     * @param hp The health points of the enemy; also the damage it deals when defeated.
+     */
+    constexpr SimEnemy(std::string_view n, std::string_view desc, int hp) : SimCharacter(n, hp, hp), description(desc) {}
+
+    constexpr std::string_view getDescription() const { return description; }
+
+    void writeStatus(std::ostream &os) const { os << "Enemy: " << name << " | Health Required to Win: " << health << "\n"; }
+};
+
+/**
+ * @brief Closed set of simulation characters for code that needs to hold either kind by value.
+ */
+using AnyCharacter = std::variant<SimPlayer, SimEnemy>;
+
+/**
+ * @brief Writes the status line of any simulation character (std::visit; no vtable involved).
+ */
+inline void displayStatus(const AnyCharacter &character, std::ostream &os)
+{
+    std::visit([&os](const auto &c) { c.displayStatus(os); }, character);
+}
+
+// The whole point of the simulation types: no vtable pointer and nothing for the optimizer to devirtualize.
+static_assert(!std::is_polymorphic<SimPlayer>::value, "SimPlayer must not have virtual functions");
+static_assert(!std::is_polymorphic<SimEnemy>::value, "SimEnemy must not have virtual functions");
+
+// =================================================================================
+// === Headless rules engine =======================================================
+// =================================================================================
+
+/**
+ * @brief The four actions of the game loops; values match the `choice` numbers (1-4).
+ */
+enum class SimAction : uint8_t
+{
+    Fight = 1,
+    Bypass = 2,
+    Backtrack = 3,
+    Quit = 4
+};
+
+/**
+ * @brief Where a simulated game stands after a turn.
+ */
+enum class SimStatus : uint8_t
+{
+    Playing,
+    Escaped,    // Cleared or slipped past the final room.
+    Died,       // Health dropped below the rules' minHealth (20).
+    OutOfMoves, // Ran out of moves.
+    Quit        // Chose to quit.
+};
+
+/**
+ * @brief One room of a dungeon template: its enemy and its tier's loot table.
+ */
+struct SimRoomTemplate
+{
+    SimEnemy enemy;
+    LootTable loot;
+};
+
+/**
+ * @brief Immutable description of a dungeon, shared by every simulated session (and thread) that plays it.
+ * Built at run time, so it can hold any rooms and items; see BuiltinCampaignRooms for the compile-time campaign.
+ */
+struct SimDungeonTemplate
+{
+    std::vector<SimRoomTemplate> rooms;
+    RuleSet constants = builtinRules;
+
+    // The room interface used by simulateTurn().
+    int roomCount() const { return static_cast<int>(rooms.size()); }
+    CombatStats enemyStats(int room) const { return rooms[room].enemy.getCombatStats(); }
+    ItemId rollLoot(int room, Rng &rng) const { return rooms[room].loot.roll(rng); }
+    std::vector<LootOdds> lootOdds(int room) const { return rooms[room].loot.odds(); }
+    const RuleSet &rules() const { return constants; }
+};
+
+/**
+ * @brief Builds the template of the built-in five-room campaign from builtinCampaign.
+ * @return The campaign's template.
+ */
+inline SimDungeonTemplate builtinSimDungeon()
+{
+    SimDungeonTemplate dungeon;
+    for (size_t tier = 0; tier < builtinCampaign.size(); ++tier)
+    {
+        const RoomDef &room = builtinCampaign[tier];
+        std::vector<std::pair<std::string, double>> drops;
+        for (const DropDef &drop : roomDrops(room, tier))
+            drops.emplace_back(std::string(drop.item), drop.weight);
+        dungeon.rooms.push_back({SimEnemy(room.enemyName, room.enemyDescription, room.enemyHealth), LootTable(drops)});
+    }
+    return dungeon;
+}
+
+/**
+ * @brief The built-in campaign as a room interface over the compile-time tables.
+ * Holds no data: room count, enemy stats and loot tables are constants, so there is nothing to build, share or free,
+ * and with a constant room index the compiler folds the lookups away.
+ */
+struct BuiltinCampaignRooms
+{
+    static constexpr int roomCount() { return static_cast<int>(builtinCampaign.size()); }
+    static constexpr CombatStats enemyStats(int room)
+    {
+        return {builtinCampaign[room].enemyHealth, builtinCampaign[room].enemyHealth, 0};
+    }
+    static ItemId rollLoot(int room, Rng &rng) { return builtinCampaignLoot[room].roll(rng); }
+    static std::vector<LootOdds> lootOdds(int room) { return builtinCampaignLoot[room].odds(); }
+    static constexpr RuleSet rules() { return builtinRules; }
+};
+
+/**
+ * @brief Where a game stands in the dungeon: the current room and the rooms left behind.
+ * Both games' Dungeon and SimSession hold one, so the rule variants below move all three the same way.
+ * A new position stands in the first room with an empty history.
+ */
+struct RoomPosition
+{
+    int roomIndex = 0;                 // Current room; equals the room count once the player has escaped.
+    std::array<uint8_t, 64> history{}; // Rooms left behind, oldest first.
+    int historyDepth = 0;              // Number of entries in history.
+    uint64_t roomZobrist = zobristRoom(0); // Zobrist hash of roomIndex and history, kept up to date by every move.
+};
+
+/**
+ * @brief Mutable state of one simulated game: the player, the position in the dungeon and the random stream.
+ * A new session stands in the first room with an empty history, where the console game's first turn starts;
+ * startSession() gives each rule variant's own opening position. Advancing pushes the room being left onto the
+ * history; what backtracking does depends on the rule variant.
+ */
+struct SimSession : RoomPosition
+{
+    SimPlayer player;
+    SimStatus status = SimStatus::Playing;
+    Rng rng;
+
+    /**
+     * @brief Constructor for the SimSession class.
+     * @param generator The game's random stream.
+     * @param startMoves The player's starting moves; pass the dungeon's rules().startMoves when they may differ.
+     */
+    explicit SimSession(Rng generator = Rng(), int startMoves = builtinRules.startMoves)
+        : player("Bot", startMoves), rng(generator) {}
+
+    /**
+     * @brief Gets the Zobrist hash of the whole state; equals zobristHash(packState(*this)).
+     */
+    uint64_t zobristHash() const { return player.getZobrist() ^ roomZobrist; }
+};
+
+// =================================================================================
+// === Rule variants ===============================================================
+// =================================================================================
+
+/**
+ * @brief Moves into the next room, pushing the room being left onto the history (both games' advance).
+ */
+inline void advanceRoom(RoomPosition &position)
+{
+    if (position.historyDepth < static_cast<int>(position.history.size()))
+    {
+        position.roomZobrist ^= zobristHistory(position.historyDepth, position.roomIndex);
+        position.history[position.historyDepth++] = static_cast<uint8_t>(position.roomIndex);
+    }
+    position.roomZobrist ^= zobristRoom(position.roomIndex) ^ zobristRoom(position.roomIndex + 1);
+    position.roomIndex++;
+}
+
+/**
+ * @brief The rules of the GUI game (updatedwithGUI.cpp), as a policy for simulateTurn() and for the game itself.
+ * - Entering play advances once without spending a move, so play starts in the second room with the first one in
+ *   the history (the dungeon starts at index 0 and the loop enters when it first reaches PLAYING).
+ * - useMove() stops at 0.
+ * - Backtracking needs two rooms in the history; it drops the newest one and moves to the room below it.
+ * - Item effects picked up on the winning turn still apply before the game ends.
+ */
+struct GuiRules
+{
+    static constexpr bool clampMoves = true;
+    static constexpr bool effectsOnEscape = true;
+
+    static void enter(RoomPosition &position) { advanceRoom(position); }
+
+    static bool backtrack(RoomPosition &position)
+    {
+        if (position.historyDepth <= 1)
+            return false;
+        position.historyDepth--;
+        position.roomZobrist ^= zobristHistory(position.historyDepth, position.history[position.historyDepth]) ^ zobristRoom(position.roomIndex);
+        position.roomIndex = position.history[position.historyDepth - 1];
+        position.roomZobrist ^= zobristRoom(position.roomIndex);
+        return true;
+    }
+};
+
+/**
+ * @brief The rules of the console game (nogui.cpp), as a policy for simulateTurn() and for the game itself.
+ * - Play starts in the first room with an empty history; entering play does nothing.
+ * - useMove() keeps counting below 0.
+ * - Backtracking needs one room in the history; it moves back to that room and removes it from the history.
+ * - Leaving the last room ends the game at once, before the turn's item effects apply.
+ */
+struct ConsoleRules
+{
+    static constexpr bool clampMoves = false;
+    static constexpr bool effectsOnEscape = false;
+
+    static void enter(RoomPosition &) {}
+
+    static bool backtrack(RoomPosition &position)
+    {
+        if (position.historyDepth < 1)
+            return false;
+        position.historyDepth--;
+        position.roomZobrist ^= zobristHistory(position.historyDepth, position.history[position.historyDepth]) ^ zobristRoom(position.roomIndex);
+        position.roomIndex = position.history[position.historyDepth];
+        position.roomZobrist ^= zobristRoom(position.roomIndex);
+        return true;
+    }
+};
+
+/**
+ * @brief Creates a session at a rule variant's opening position.
+ * @tparam Variant The rules (GuiRules or ConsoleRules).
+ * @param generator The game's random stream.
+ * @param startMoves The player's starting moves.
+ * @return The session, ready for its first turn.
+ */
+template <typename Variant>
+SimSession startSession(Rng generator = Rng(), int startMoves = builtinRules.startMoves)
+{
+    SimSession session(generator, startMoves);
+    Variant::enter(session);
+    return session;
+}
+
+/**
+ * @brief The random events of a turn drawn from the session's own stream: what simulateTurn() normally uses.
+ * @tparam Rooms The dungeon's room interface.
+ */
+template <typename Rooms>
+struct SessionChance
+{
+    Rng &rng;
+    const Rooms &dungeon;
+
+    CombatResult fight(const CombatStats &player, const CombatStats &enemy) { return resolveCombat(player, enemy, rng); }
+    ItemId loot(int room) { return dungeon.rollLoot(room, rng); }
+};
+
+/**
+ * @brief Plays one turn on a simulated session, taking the random events from a chance source.
+ * Both games' rules are this one function: the points where they differ come from the Variant policy as
+ * compile-time constants and inlined calls, so each variant is its own instantiation with no run-time switch.
+ * A turn has at most three events, in this order: the fight, then the two loot drops if the player won.
+ * @tparam Variant The rules (GuiRules or ConsoleRules).
+ * @tparam Rooms The dungeon's room interface: roomCount(), enemyStats(room), rollLoot(room, rng), lootOdds(room)
+ * and rules() (SimDungeonTemplate, BuiltinCampaignRooms or TunedRooms).
+ * @tparam Chance Provides fight(playerStats, enemyStats) -> CombatResult and loot(room) -> ItemId
+ * (SessionChance, or a scripted source that enumerates outcomes).
+ * @param session The session to advance; must still be Playing.
+ * @param dungeon The dungeon being played.
+ * @param action The player's choice.
+ * @param chance The source of the turn's random events.
+ * @return The session's status after the turn.
+ */
+template <typename Variant = GuiRules, typename Rooms, typename Chance>
+SimStatus simulateTurn(SimSession &session, const Rooms &dungeon, SimAction action, Chance &chance)
+{
+    SimPlayer &player = session.player;
+    const int roomCount = dungeon.roomCount();
+    const RuleSet rules = dungeon.rules();
+
+    player.useMove<Variant::clampMoves>();
+    switch (action)
+    {
+    case SimAction::Fight:
+    {
+        const int room = session.roomIndex;
+        CombatResult result = chance.fight(player.getCombatStats(), dungeon.enemyStats(room));
+        player.takeDamage(result.playerWon ? result.winDamage : rules.fleeDamage);
+        if (result.playerWon)
+        {
+            player.addItem(chance.loot(room));
+            player.addItem(chance.loot(room));
+            player.addCoins(rules.winCoins);
+            player.incrementEnemiesDefeated();
+            advanceRoom(session);
+        }
+        break;
+    }
+    case SimAction::Bypass:
+        player.takeDamage(rules.bypassDamage);
+        advanceRoom(session);
+        break;
+    case SimAction::Backtrack:
+        Variant::backtrack(session);
+        break;
+    case SimAction::Quit:
+        return session.status = SimStatus::Quit;
+    }
+    if (!Variant::effectsOnEscape && session.roomIndex >= roomCount)
+        return session.status = SimStatus::Escaped;
+    player.applyPendingEffects();
+
+    if (session.roomIndex >= roomCount)
+        session.status = SimStatus::Escaped;
+    else if (player.getHealth() < rules.minHealth)
+        session.status = SimStatus::Died;
+    else if (player.getMoves() <= 0)
+        session.status = SimStatus::OutOfMoves;
+    return session.status;
+}
+
+/**
+ * @brief Plays one turn on a simulated session, drawing dice and loot from its stream.
+ * @tparam Variant The rules; the GUI game's by default.
+ * @tparam Rooms The dungeon's room interface (see above).
+ * @param session The session to advance; must still be Playing.
+ * @param dungeon The dungeon being played.
+ * @param action The player's choice.
+ * @return The session's status after the turn.
+ */
+template <typename Variant = GuiRules, typename Rooms>
+SimStatus simulateTurn(SimSession &session, const Rooms &dungeon, SimAction action)
+{
+    SessionChance<Rooms> chance{session.rng, dungeon};
+    return simulateTurn<Variant>(session, dungeon, action, chance);
+}
+
+/**
+ * @brief Plays a whole game with a policy choosing every action.
+ * @tparam Variant The rules; the GUI game's by default.
+ * @tparam Rooms The dungeon's room interface (see simulateTurn).
+ * @tparam Policy A callable taking (const SimSession&, const Rooms&) and returning a SimAction.
+ * @param session The session to play; usually freshly constructed.
+ * @param dungeon The dungeon to play.
+ * @param policy The decision maker.
+ * @return The final status.
+ */
+template <typename Variant = GuiRules, typename Rooms, typename Policy>
+SimStatus simulateGame(SimSession &session, const Rooms &dungeon, Policy &&policy)
+{
+    while (session.status == SimStatus::Playing)
+        simulateTurn<Variant>(session, dungeon, policy(static_cast<const SimSession &>(session), dungeon));
+    return session.status;
+}
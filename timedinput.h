@@ -0,0 +1,338 @@
+#pragma once
+
+#include <cstdint>     // Required for fixed-width integer types
+#include <cstddef>     // Required for size_t
+#include <cerrno>      // Required for errno (interrupted waits)
+#include <vector>      // Required for std::vector (sessions, events, read buffers)
+#include <chrono>      // Required for steady_clock (monotonic deadlines)
+#include <string_view> // Required for std::string_view (words read in place)
+#include <stdexcept>   // Required for std::runtime_error, std::out_of_range
+#include <limits>      // Required for std::numeric_limits (no pending deadline)
+
+#include <unistd.h> // Required for read
+#include "timerwheel.h" // Session deadlines
+
+#ifdef __linux__
+#include <sys/epoll.h> // Required for epoll (Linux backend)
+#else
+#include <poll.h> // Required for poll (portable backend)
+#endif
+
+// =================================================================================
+// === Timed, multiplexed input ====================================================
+// =================================================================================
+//
+// Input that can be waited for with a deadline, on any number of sessions at once, from one thread: each session is
+// a file descriptor (a terminal, a pipe, a socket) with its own word buffer and optional deadline. InputMux::wait()
+// sleeps in epoll (Linux) or poll until a session has input, reaches end of file, or misses its deadline.
+// Deadlines use the monotonic clock, so changing the system time cannot stretch or cut a challenge short.
+// POSIX only.
+
+using MonoClock = std::chrono::steady_clock;
+
+/**
+ * @brief Whitespace-separated words arriving on one file descriptor, buffered until they are complete.
+ */
+class InputReader
+{
+private:
+    std::vector<char> buffer;
+    size_t start = 0;      // First unread byte.
+    bool ended = false;    // The descriptor reached end of file (or failed).
+    bool skipping = false; // Discarding up to the next newline.
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+    // Drops bytes up to and including the next newline; false if none has arrived yet.
+    bool finishSkip()
+    {
+        while (start < buffer.size())
+        {
+            if (buffer[start++] == '\n')
+            {
+                skipping = false;
+                return true;
+            }
+        }
+        return ended;
+    }
+
+public:
+    /**
+     * @brief Reads what is available on a descriptor that poll reported ready. One read() never blocks then.
+     * @param fd The descriptor.
+     * @return False once the descriptor has reached end of file.
+     */
+    bool fill(int fd)
+    {
+        if (start > 0 && start * 2 >= buffer.size()) // Reuse the space of consumed words.
+        {
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(start));
+            start = 0;
+        }
+        const size_t used = buffer.size();
+        buffer.resize(used + 4096);
+        ssize_t got;
+        do
+            got = ::read(fd, buffer.data() + used, 4096);
+        while (got < 0 && errno == EINTR);
+        buffer.resize(used + (got > 0 ? static_cast<size_t>(got) : 0));
+        if (got <= 0)
+            ended = true;
+        return !ended;
+    }
+
+    /**
+     * @brief Takes the next complete word. A word is complete once whitespace or end of file follows it.
+     * @param word Set to the word; valid until the next fill().
+     * @return False if no complete word has arrived yet (or none is left, see atEnd()).
+     */
+    bool nextWord(std::string_view &word)
+    {
+        if (skipping && !finishSkip())
+            return false;
+        size_t begin = start;
+        while (begin < buffer.size() && isSpace(buffer[begin]))
+            ++begin;
+        size_t end = begin;
+        while (end < buffer.size() && !isSpace(buffer[end]))
+            ++end;
+        if (begin == end || (end == buffer.size() && !ended))
+        {
+            start = begin; // Whitespace is consumed; a partial word waits for more input.
+            return false;
+        }
+        word = std::string_view(buffer.data() + begin, end - begin);
+        start = end;
+        return true;
+    }
+
+    /**
+     * @brief Discards the rest of the current line, including input that has not arrived yet.
+     */
+    void skipLine()
+    {
+        skipping = true;
+        finishSkip();
+    }
+
+    /**
+     * @brief Whether the input has ended and every word has been taken.
+     */
+    bool atEnd() const
+    {
+        if (!ended)
+            return false;
+        for (size_t i = start; i < buffer.size(); ++i)
+            if (!isSpace(buffer[i]))
+                return false;
+        return true;
+    }
+};
+
+/**
+ * @brief What happened to a session during InputMux::wait().
+ */
+enum class MuxEventKind : uint8_t
+{
+    Input,    // New bytes arrived; the session's reader may have complete words.
+    Closed,   // End of file; the session is no longer watched.
+    Deadline, // The session's deadline passed before it was cleared.
+};
+
+struct MuxEvent
+{
+    int session;
+    MuxEventKind kind;
+};
+
+/**
+ * @brief Waits on many input sessions at once, each with an optional monotonic deadline, without threads.
+ * Deadlines are timers of a 100 us TimerWheel, so setting, moving and clearing one are O(1).
+ */
+class InputMux
+{
+private:
+    struct Session
+    {
+        int fd = -1;
+        bool open = false;
+        TimerHandle deadline;
+        InputReader reader;
+    };
+
+    std::vector<Session> sessions;
+    TimerWheel<int> deadlines{std::chrono::microseconds(100)}; // Payload: the session. Finer than the waits, which are whole ms.
+    size_t openCount = 0;
+#ifdef __linux__
+    int epollFd;
+    std::vector<epoll_event> ready;
+#else
+    std::vector<pollfd> watched; // Rebuilt lazily from the open sessions.
+    std::vector<int> watchedSessions;
+    bool watchedStale = true;
+#endif
+
+    // Reports every deadline that has passed; returns when the next one may pass (max if none is set).
+    MonoClock::time_point collectExpired(std::vector<MuxEvent> &events)
+    {
+        deadlines.advance(MonoClock::now(), [&](int session) { events.push_back({session, MuxEventKind::Deadline}); });
+        const uint64_t ticks = deadlines.ticksUntilNext();
+        if (ticks == std::numeric_limits<uint64_t>::max())
+            return MonoClock::time_point::max();
+        return deadlines.timeOfTick(deadlines.currentTick() + ticks);
+    }
+
+    void readSession(int id, std::vector<MuxEvent> &events)
+    {
+        Session &session = sessions[id];
+        if (session.reader.fill(session.fd))
+        {
+            events.push_back({id, MuxEventKind::Input});
+            return;
+        }
+        events.push_back({id, MuxEventKind::Closed});
+        close(id);
+    }
+
+    void close(int id)
+    {
+        Session &session = sessions[id];
+        if (!session.open)
+            return;
+#ifdef __linux__
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+#else
+        watchedStale = true;
+#endif
+        session.open = false;
+        deadlines.cancel(session.deadline);
+        openCount--;
+    }
+
+public:
+    InputMux()
+    {
+#ifdef __linux__
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0)
+            throw std::runtime_error("Cannot create an epoll instance.");
+#endif
+    }
+
+    ~InputMux()
+    {
+#ifdef __linux__
+        ::close(epollFd);
+#endif
+    }
+
+    InputMux(const InputMux &) = delete;
+    InputMux &operator=(const InputMux &) = delete;
+
+    /**
+     * @brief Starts watching a descriptor. The descriptor stays owned (and open) by the caller.
+     * @return The session's ID.
+     * @throws runtime_error If the descriptor cannot be watched.
+     */
+    int add(int fd)
+    {
+        const int id = static_cast<int>(sessions.size());
+#ifdef __linux__
+        epoll_event interest{};
+        interest.events = EPOLLIN;
+        interest.data.u32 = static_cast<uint32_t>(id);
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &interest) != 0)
+            throw std::runtime_error("Cannot watch this input (epoll needs a terminal, pipe or socket).");
+#else
+        watchedStale = true;
+#endif
+        sessions.emplace_back();
+        sessions.back().fd = fd;
+        sessions.back().open = true;
+        openCount++;
+        return id;
+    }
+
+    /**
+     * @brief Stops watching a session.
+     */
+    void remove(int session) { close(session); }
+
+    /**
+     * @brief Sets (or moves) a session's deadline; wait() reports it once when it passes.
+     */
+    void setDeadline(int session, MonoClock::time_point when)
+    {
+        Session &s = sessions.at(static_cast<size_t>(session));
+        deadlines.cancel(s.deadline);
+        s.deadline = deadlines.scheduleAt(when, session);
+    }
+
+    /**
+     * @brief Cancels a session's deadline.
+     */
+    void clearDeadline(int session)
+    {
+        deadlines.cancel(sessions.at(static_cast<size_t>(session)).deadline);
+    }
+
+    InputReader &reader(int session) { return sessions.at(static_cast<size_t>(session)).reader; }
+
+    size_t getOpenSessions() const { return openCount; }
+
+    /**
+     * @brief Waits until at least one session has input, closes or misses its deadline, or `until` passes.
+     * @param events Cleared, then filled with what happened.
+     * @param until Latest time to return at, even if nothing happened.
+     * @return The number of events.
+     */
+    size_t wait(std::vector<MuxEvent> &events, MonoClock::time_point until = MonoClock::time_point::max())
+    {
+        events.clear();
+        MonoClock::time_point next = collectExpired(events);
+        if (!events.empty())
+            return events.size();
+        if (until < next)
+            next = until;
+
+        int timeoutMs = -1; // Forever.
+        if (next != MonoClock::time_point::max())
+        {
+            const auto left = next - MonoClock::now();
+            // Round up, so the wait never ends before the deadline has passed.
+            const auto ms = std::chrono::ceil<std::chrono::milliseconds>(left).count();
+            timeoutMs = ms <= 0 ? 0 : static_cast<int>(ms < 86400000 ? ms : 86400000);
+        }
+        if (openCount == 0 && timeoutMs < 0)
+            return 0; // Nothing could ever happen.
+
+#ifdef __linux__
+        ready.resize(openCount ? openCount : 1);
+        const int count = epoll_wait(epollFd, ready.data(), static_cast<int>(ready.size()), timeoutMs);
+        for (int i = 0; i < count; ++i)
+            readSession(static_cast<int>(ready[i].data.u32), events);
+#else
+        if (watchedStale)
+        {
+            watched.clear();
+            watchedSessions.clear();
+            for (size_t id = 0; id < sessions.size(); ++id)
+            {
+                if (sessions[id].open)
+                {
+                    watched.push_back({sessions[id].fd, POLLIN, 0});
+                    watchedSessions.push_back(static_cast<int>(id));
+                }
+            }
+            watchedStale = false;
+        }
+        const int count = poll(watched.data(), static_cast<nfds_t>(watched.size()), timeoutMs);
+        for (size_t i = 0; count > 0 && i < watched.size(); ++i)
+            if (watched[i].revents)
+                readSession(watchedSessions[i], events);
+#endif
+        collectExpired(events);
+        return events.size();
+    }
+};
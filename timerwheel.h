@@ -0,0 +1,324 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <array>     // Required for std::array (wheel slots, occupancy bits)
+#include <vector>    // Required for std::vector (timer pool)
+#include <chrono>    // Required for steady_clock (the wheel's time base)
+#include <limits>    // Required for std::numeric_limits
+#include <utility>   // Required for std::move
+
+#include "platform.h" // countTrailingZeros, prefetch
+
+// =================================================================================
+// === Hierarchical timer wheel ====================================================
+// =================================================================================
+//
+// Schedules any number of timers (challenge clocks, effect durations, autosaves, per-session deadlines) at a fixed
+// tick resolution. Eight levels of 256 slots cover the whole 64-bit tick range: a timer sits in the level of the
+// highest byte in which its expiry differs from the current tick, and moves down a level each time the wheel reaches
+// that byte's boundary. Scheduling and cancelling are O(1); advancing is O(1) per tick plus O(1) per timer moved or
+// fired, and stretches of empty slots are skipped 256 ticks at a time.
+//
+// Timers live in a pooled array and each slot is a list of their indices, so after warm-up scheduling does not allocate,
+// and moving or firing a slot's timers walks an array (fetching the timers ahead) rather than chasing links. Handles
+// carry a generation, so cancelling a timer that has already fired (or whose node was reused) is a harmless no-op.
+
+/**
+ * @brief Identifies a scheduled timer. A default-constructed handle refers to no timer.
+ */
+struct TimerHandle
+{
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    bool valid() const { return index != std::numeric_limits<uint32_t>::max(); }
+};
+
+/**
+ * @brief A hierarchical timer wheel.
+ * @tparam Payload What a timer carries to its callback (e.g. an event kind or a session ID); copied when it fires.
+ */
+template <typename Payload>
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static const int levels = 8;
+    static const int slotBits = 8;
+    static const uint32_t slotsPerLevel = 1u << slotBits;
+
+private:
+    static const uint32_t nil = std::numeric_limits<uint32_t>::max();
+    static const size_t prefetchDistance = 8; // Timers ahead whose nodes are fetched while one is processed.
+
+    struct Node
+    {
+        uint64_t expiry = 0;      // Tick at which the timer fires.
+        uint32_t generation = 0;
+        uint32_t position = nil;  // Index in its slot's list, or the next free node while unused.
+        uint16_t slot = 0;        // level * slotsPerLevel + slot index.
+        bool armed = false;
+        Payload payload{};
+    };
+
+    std::vector<Node> nodes;
+    uint32_t freeList = nil;
+    std::array<std::vector<uint32_t>, levels * slotsPerLevel> slots;          // Node indices per slot, unordered.
+    std::array<std::array<uint64_t, slotsPerLevel / 64>, levels> occupied{}; // Non-empty slots per level.
+    uint64_t now = 0;         // The last tick processed.
+    size_t active = 0;
+    Clock::time_point origin; // Time of tick 0.
+    Clock::duration tick;
+
+    void markSlot(size_t slot, bool full)
+    {
+        uint64_t &word = occupied[slot / slotsPerLevel][(slot % slotsPerLevel) / 64];
+        const uint64_t bit = uint64_t(1) << (slot % 64);
+        word = full ? word | bit : word & ~bit;
+    }
+
+    void prefetch(uint32_t index) const { ::prefetch(&nodes[index]); }
+
+    // Files a timer due at or after the current tick. One due now goes into the current level-0 slot, which is only
+    // the case while advanceToTick() cascades, just before it fires that slot.
+    void link(uint32_t index)
+    {
+        Node &node = nodes[index];
+        const uint64_t differing = node.expiry ^ now;
+        int level = 0;
+        while (level + 1 < levels && (differing >> (slotBits * (level + 1))) != 0)
+            ++level;
+        const size_t slot = static_cast<size_t>(level) * slotsPerLevel + ((node.expiry >> (slotBits * level)) & (slotsPerLevel - 1));
+        node.slot = static_cast<uint16_t>(slot);
+        node.position = static_cast<uint32_t>(slots[slot].size());
+        slots[slot].push_back(index);
+        markSlot(slot, true);
+    }
+
+    // Removes a timer from its slot by moving the slot's last timer into its place.
+    void unlink(uint32_t index)
+    {
+        const Node &node = nodes[index];
+        std::vector<uint32_t> &list = slots[node.slot];
+        const uint32_t moved = list.back();
+        list[node.position] = moved;
+        nodes[moved].position = node.position;
+        list.pop_back();
+        if (list.empty())
+            markSlot(node.slot, false);
+    }
+
+    void release(uint32_t index)
+    {
+        Node &node = nodes[index];
+        node.armed = false;
+        node.generation++;
+        node.position = freeList;
+        freeList = index;
+        active--;
+    }
+
+    // Moves every timer of a slot on a higher level down to where it now belongs (always a lower level).
+    void cascade(size_t slot)
+    {
+        std::vector<uint32_t> &list = slots[slot];
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (i + prefetchDistance < list.size())
+                prefetch(list[i + prefetchDistance]);
+            link(list[i]);
+        }
+        list.clear(); // Keeps its capacity.
+        markSlot(slot, false);
+    }
+
+    bool levelZeroEmptyUntilBoundary() const
+    {
+        const uint32_t from = static_cast<uint32_t>((now + 1) & (slotsPerLevel - 1));
+        for (uint32_t word = from / 64; word < slotsPerLevel / 64; ++word)
+        {
+            uint64_t bits = occupied[0][word];
+            if (word == from / 64)
+                bits &= ~uint64_t(0) << (from % 64);
+            if (bits)
+                return false;
+        }
+        return true;
+    }
+
+public:
+    /**
+     * @brief Constructor for the TimerWheel class.
+     * @param resolution Length of one tick; timers fire on the first tick at or after their time.
+     * @param start Time of tick 0.
+     */
+    explicit TimerWheel(Clock::duration resolution = std::chrono::milliseconds(1), Clock::time_point start = Clock::now())
+        : origin(start), tick(resolution)
+    {
+    }
+
+    /**
+     * @brief Reserves pool space for `count` timers, so scheduling up to that many never allocates.
+     */
+    void reserve(size_t count) { nodes.reserve(count); }
+
+    /**
+     * @brief Converts a time to the wheel's ticks, rounding up.
+     */
+    uint64_t toTick(Clock::time_point when) const
+    {
+        if (when <= origin)
+            return 0;
+        return static_cast<uint64_t>((when - origin + tick - Clock::duration(1)) / tick);
+    }
+
+    /**
+     * @brief Converts a time to the last tick that has fully started (for advancing).
+     */
+    uint64_t toTickFloor(Clock::time_point when) const
+    {
+        return when <= origin ? 0 : static_cast<uint64_t>((when - origin) / tick);
+    }
+
+    /**
+     * @brief Schedules a timer for a tick.
+     * @param expiry The tick it fires at; ticks that have passed fire on the next advance.
+     * @param payload Handed to the callback when it fires.
+     * @return A handle for cancel().
+     */
+    TimerHandle scheduleAtTick(uint64_t expiry, Payload payload)
+    {
+        uint32_t index;
+        if (freeList != nil)
+        {
+            index = freeList;
+            freeList = nodes[index].position;
+        }
+        else
+        {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        Node &node = nodes[index];
+        node.expiry = expiry > now ? expiry : now + 1; // Overdue: fire on the next tick.
+        node.payload = std::move(payload);
+        node.armed = true;
+        link(index);
+        active++;
+        return {index, node.generation};
+    }
+
+    TimerHandle scheduleAt(Clock::time_point when, Payload payload) { return scheduleAtTick(toTick(when), std::move(payload)); }
+
+    /**
+     * @brief Schedules a timer `delay` after the wheel's current tick.
+     */
+    TimerHandle scheduleIn(Clock::duration delay, Payload payload)
+    {
+        const uint64_t ticks = delay <= Clock::duration::zero() ? 0 : static_cast<uint64_t>((delay + tick - Clock::duration(1)) / tick);
+        return scheduleAtTick(now + ticks, std::move(payload));
+    }
+
+    /**
+     * @brief Cancels a timer. Does nothing if it has already fired or been cancelled.
+     * @return True if a pending timer was cancelled.
+     */
+    bool cancel(TimerHandle handle)
+    {
+        if (!pending(handle))
+            return false;
+        unlink(handle.index);
+        release(handle.index);
+        return true;
+    }
+
+    /**
+     * @brief Whether a timer is still waiting to fire.
+     */
+    bool pending(TimerHandle handle) const
+    {
+        return handle.index < nodes.size() && nodes[handle.index].armed && nodes[handle.index].generation == handle.generation;
+    }
+
+    /**
+     * @brief Processes every tick up to `target`, calling onExpire(payload) for each timer that fires, in tick order.
+     * Callbacks may schedule and cancel timers; timers they schedule for a processed tick fire on the next tick.
+     * @return The number of timers fired.
+     */
+    template <typename Fn>
+    size_t advanceToTick(uint64_t target, Fn &&onExpire)
+    {
+        size_t fired = 0;
+        while (now < target)
+        {
+            if (active == 0)
+            {
+                now = target; // Nothing to move or fire.
+                break;
+            }
+            const uint64_t boundary = (now | (slotsPerLevel - 1)) + 1; // Next tick with a zero low byte.
+            if (levelZeroEmptyUntilBoundary() && boundary - 1 > now)
+            {
+                now = target < boundary - 1 ? target : boundary - 1; // Skip the empty rest of this revolution.
+                continue;
+            }
+            ++now;
+            // Reaching a byte boundary moves the matching slot of each higher level down, highest level first.
+            int top = countTrailingZeros(now) / slotBits; // Whole zero bytes at the bottom of the tick.
+            if (top > levels - 1)
+                top = levels - 1;
+            for (int level = top; level >= 1; --level)
+                cascade(static_cast<size_t>(level) * slotsPerLevel + ((now >> (slotBits * level)) & (slotsPerLevel - 1)));
+
+            // Callbacks cannot add to this slot (new timers fire on a later tick), but may cancel timers in it.
+            std::vector<uint32_t> &due = slots[now & (slotsPerLevel - 1)];
+            while (!due.empty())
+            {
+                if (due.size() > prefetchDistance)
+                    prefetch(due[due.size() - 1 - prefetchDistance]);
+                const uint32_t index = due.back();
+                unlink(index);
+                Payload payload = std::move(nodes[index].payload);
+                release(index);
+                fired++;
+                onExpire(payload);
+            }
+        }
+        return fired;
+    }
+
+    template <typename Fn>
+    size_t advance(Clock::time_point time, Fn &&onExpire) { return advanceToTick(toTickFloor(time), std::forward<Fn>(onExpire)); }
+
+    /**
+     * @brief A lower bound on the ticks until the next timer can fire: exact when a timer is due within the
+     * current revolution, otherwise the next revolution boundary (where timers move down). Max if none is pending.
+     * Loops use it to sleep (poll, epoll, sf::sleep) without missing a timer.
+     */
+    uint64_t ticksUntilNext() const
+    {
+        if (active == 0)
+            return std::numeric_limits<uint64_t>::max();
+        const uint32_t from = static_cast<uint32_t>((now + 1) & (slotsPerLevel - 1));
+        for (uint32_t word = from / 64; word < slotsPerLevel / 64; ++word)
+        {
+            uint64_t bits = occupied[0][word];
+            if (word == from / 64)
+                bits &= ~uint64_t(0) << (from % 64);
+            if (bits)
+                return word * 64 + static_cast<uint32_t>(countTrailingZeros(bits)) - (now & (slotsPerLevel - 1));
+        }
+        return ((now | (slotsPerLevel - 1)) + 1) - now;
+    }
+
+    /**
+     * @brief Time of the given tick.
+     */
+    Clock::time_point timeOfTick(uint64_t tickIndex) const { return origin + tick * static_cast<int64_t>(tickIndex); }
+
+    uint64_t currentTick() const { return now; }
+
+    size_t size() const { return active; }
+};
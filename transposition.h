@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>   // Required for fixed-width integer types
+#include <cstddef>   // Required for size_t
+#include <cstring>   // Required for memcpy (float bits)
+#include <atomic>    // Required for std::atomic (lock-free slots)
+#include <memory>    // Required for std::unique_ptr (slot storage)
+#include <stdexcept> // Required for std::invalid_argument
+
+/**
+ * @brief What the transposition table remembers about a state: a value (e.g. a win rate) and how much work backs it
+ * (e.g. rollouts or search depth). A zero evaluation (value 0, count 0) means "nothing known" and reads as a miss.
+ */
+struct Evaluation
+{
+    float value;
+    uint32_t count;
+};
+
+/**
+ * @brief Probe and store counters of one thread (or one search). Kept by the caller rather than in the table so
+ * threads never contend on shared counters; add them up with += when the threads finish.
+ */
+struct TranspositionStats
+{
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    uint64_t stores = 0;
+
+    /**
+     * @brief Gets the fraction of probes that found their state.
+     */
+    double hitRate() const { return probes ? static_cast<double>(hits) / static_cast<double>(probes) : 0.0; }
+
+    TranspositionStats &operator+=(const TranspositionStats &other)
+    {
+        probes += other.probes;
+        hits += other.hits;
+        stores += other.stores;
+        return *this;
+    }
+};
+
+/**
+ * @brief Fixed-size, lock-free cache of state evaluations keyed by Zobrist hash, shared by any number of threads.
+ * Each slot holds two words: the packed evaluation and the hash XOR-ed with it. A probe only accepts a slot whose
+ * words decode back to the probed hash, so a slot torn by a concurrent store reads as a miss instead of a wrong hit.
+ * New stores always replace the slot's old entry. The table never allocates after construction.
+ */
+class TranspositionTable
+{
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> check{0}; // hash ^ data.
+        std::atomic<uint64_t> data{0};  // Packed Evaluation.
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask; // Slot count - 1 (the count is a power of two).
+
+    static uint64_t pack(const Evaluation &evaluation)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &evaluation.value, sizeof(bits));
+        return (static_cast<uint64_t>(evaluation.count) << 32) | bits;
+    }
+
+    static Evaluation unpack(uint64_t data)
+    {
+        Evaluation evaluation;
+        const uint32_t bits = static_cast<uint32_t>(data);
+        std::memcpy(&evaluation.value, &bits, sizeof(bits));
+        evaluation.count = static_cast<uint32_t>(data >> 32);
+        return evaluation;
+    }
+
+    // Returns slotCount if it is a power of two; runs before the slots are allocated.
+    static size_t checkedSlotCount(size_t slotCount)
+    {
+        if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0)
+            throw std::invalid_argument("Transposition table size must be a power of two.");
+        return slotCount;
+    }
+
+public:
+    /**
+     * @brief Constructor for the TranspositionTable class.
+     * @param slotCount Number of slots; must be a power of two. Each slot takes 16 bytes.
+     * @throws invalid_argument If slotCount is not a power of two.
+     */
+    explicit TranspositionTable(size_t slotCount)
+        : slots(new Slot[checkedSlotCount(slotCount)]), mask(slotCount - 1) {}
+
+    /**
+     * @brief Looks a state up.
+     * @param hash The state's Zobrist hash.
+     * @param evaluation Receives the stored evaluation on a hit.
+     * @param stats Counters to update.
+     * @return True if the state was found.
+     */
+    bool probe(uint64_t hash, Evaluation &evaluation, TranspositionStats &stats) const
+    {
+        const Slot &slot = slots[hash & mask];
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const uint64_t check = slot.check.load(std::memory_order_relaxed);
+        ++stats.probes;
+        if ((check ^ data) != hash || data == 0)
+            return false;
+        ++stats.hits;
+        evaluation = unpack(data);
+        return true;
+    }
+
+    /**
+     * @brief Stores a state's evaluation, replacing whatever the slot held.
+     * @param hash The state's Zobrist hash.
+     * @param evaluation The evaluation to store.
+     * @param stats Counters to update.
+     */
+    void store(uint64_t hash, const Evaluation &evaluation, TranspositionStats &stats)
+    {
+        Slot &slot = slots[hash & mask];
+        const uint64_t data = pack(evaluation);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(hash ^ data, std::memory_order_relaxed);
+        ++stats.stores;
+    }
+
+    /**
+     * @brief Empties the table. Not safe while other threads probe or store.
+     */
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            slots[i].data.store(0, std::memory_order_relaxed);
+            slots[i].check.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Gets the number of slots.
+     */
+    size_t size() const { return mask + 1; }
+};
@@ -1,41 +1,126 @@
+#ifndef DUNGEON_HEADLESS
 #include <SFML/Graphics.hpp> // Required for SFML graphics functionalities
+#endif
 #include <iostream>          // Required for input/output operations (cout, cin, cerr)
 #include <string>            // Required for string manipulation
+#include <string_view>       // Required for std::string_view (non-copying item names)
 #include <vector>            // Required for std::vector container
 #include <queue>             // Required for std::queue container
-#include <stack>             // Required for std::stack container
 #include <memory>            // Required for smart pointers (std::unique_ptr)
 #include <list>              // Required for std::list container
 #include <algorithm>         // Required for std::transform and std::sort (for sorting)
 #include <limits>            // Required for numeric_limits (though not explicitly used for limits in the final code)
 #include <sstream>           // Required for std::stringstream for string building
+#include <array>             // Required for std::array (status line buffers)
+#include <charconv>          // Required for std::to_chars (numbers in reused status lines)
 #include <stdexcept>         // Required for standard exception types (e.g., out_of_range, runtime_error)
+#include <cstdlib>           // Required for strtoull (seed argument)
+#include <cstdio>            // Required for snprintf (allocation overlay)
+
+#include "random.h"          // Seeded PRNG subsystem (Rng, RngStreams)
+#include "combat.h"          // Dice-based combat model (CombatStats, resolveCombat)
+#include "effects.h"         // Table-driven item effects (EffectQueue)
+#include "items.h"           // Item registry and counted inventory stacks (ItemId, Inventory)
+#include "loot.h"            // Alias-method loot tables (behind CompiledLoot)
+#include "ecs.h"             // Entity-component storage behind Character (World, Entity)
+#include "campaign.h"        // Compile-time campaign tables (builtinCampaign, roomDrops)
+#include "gamestate.h"       // Bit-packed game state (PackedState)
+#include "zobrist.h"         // Zobrist keys (incremental state hashes)
+#include "mcts.h"            // Monte Carlo tree search bot (MctsSearch)
+#include "assets.h"          // Templated asset storage (GameAssetManager)
+#include "alloc.h"           // Opt-in allocation counts per subsystem (AllocScope, AllocWindow)
+#include "log.h"             // Rate-limited structured logging (DUNGEON_LOG, logger)
+#include "timerwheel.h"      // Hierarchical timer wheel (timed challenges)
+#include <chrono>            // Required for the bot's per-move time budget
 
 using namespace std; // Using the standard namespace to avoid prefixing std::
 
+using GameRules = GuiRules; // The rule variant (simulation.h) this game plays by; the bot simulates the same one.
+
 /**
  * @brief Base abstract class for all characters in the game.
- * Provides common attributes like name and health, and a pure virtual function for displaying status.
+ * A thin handle onto an entity of an ECS World: name, health and combat stats live in dense component pools,
+ * so systems can process thousands of characters without touching the objects themselves.
+ * Provides a pure virtual function for displaying status.
  */
 class Character
 {
 protected: // Protected members are accessible within the class and by derived classes.
-    string name;
-    int health;
+    World *world; // The world storing this character's components.
+    Entity id;    // This character's entity in that world.
+
+    /**
+     * @brief Gets a writable reference to the character's health component.
+     */
+    int &healthRef() { return world->health.get(id); }
+
+    /**
+     * @brief Gets a writable reference to the character's attack/defense component.
+     */
+    StatsComponent &statsRef() { return world->stats.get(id); }
 
 public: // Public members are accessible from outside the class.
     /**
      * @brief Constructor for the Character class.
-     * @param n The name of the character.
+     * Creates the character's entity in the default world.
+     * @param n The name of the character (interned into the world's name table).
      * @param h The initial health of the character.
+     * @param atk The attack stat used in combat.
+     * @param def The defense stat used in combat.
+     */
+    Character(const string &n, int h, int atk = 0, int def = 0) : world(&defaultWorld()), id(world->createCharacter(n, h, atk, def)) {}
+
+    /**
+     * @brief Copy constructor. The copy gets its own entity, so characters keep value semantics.
+     * @param other The character to copy.
      */
-    Character(string n, int h) : name(n), health(h) {}
+    Character(const Character &other) : world(other.world), id(world->clone(other.id)) {}
+
+    /**
+     * @brief Move constructor. Takes over the other character's entity.
+     * @param other The character to move from.
+     */
+    Character(Character &&other) noexcept : world(other.world), id(other.id) { other.id = invalidEntity; }
+
+    /**
+     * @brief Copy assignment. Releases this character's entity and takes a copy of the other's.
+     * @param other The character to copy.
+     * @return A reference to this character.
+     */
+    Character &operator=(const Character &other)
+    {
+        if (this != &other)
+        {
+            Entity copy = other.world->clone(other.id);
+            if (id != invalidEntity)
+                world->destroy(id);
+            world = other.world;
+            id = copy;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment. Swaps entities; the old one is released when the other character is destroyed.
+     * @param other The character to move from.
+     * @return A reference to this character.
+     */
+    Character &operator=(Character &&other) noexcept
+    {
+        swap(world, other.world);
+        swap(id, other.id);
+        return *this;
+    }
 
     /**
      * @brief Virtual destructor to ensure proper cleanup of derived classes.
-     * It's crucial for polymorphic classes to have a virtual destructor.
+     * It's crucial for polymorphic classes to have a virtual destructor. Releases the character's entity.
      */
-    virtual ~Character() = default; // Using default destructor as no custom cleanup is needed.
+    virtual ~Character()
+    {
+        if (id != invalidEntity) // Moved-from characters no longer own an entity.
+            world->destroy(id);
+    }
 
     /**
      * @brief Pure virtual function to display the status of the character.
@@ -45,15 +130,31 @@ public: // Public members are accessible from outside the class.
 
     /**
      * @brief Gets the name of the character.
-     * @return The name of the character.
+     * @return The name of the character, stored in the world's name table (no copy).
      */
-    string getName() const { return name; }
+    const string &getName() const { return world->nameTable.get(world->names.get(id)); }
 
     /**
      * @brief Gets the current health of the character.
      * @return The current health of the character.
      */
-    int getHealth() const { return health; }
+    int getHealth() const { return world->health.get(id); }
+
+    /**
+     * @brief Gets the defense of the character (damage reduction for the player).
+     * @return The character's defense.
+     */
+    int getDefense() const { return world->stats.get(id).defense; }
+
+    /**
+     * @brief Gets the stats used by the dice-based combat model.
+     * @return The character's health, attack and defense.
+     */
+    CombatStats getCombatStats() const
+    {
+        const StatsComponent &stats = world->stats.get(id);
+        return {getHealth(), stats.attack, stats.defense};
+    }
 
     /**
      * @brief Reduces the character's health by a specified amount.
@@ -62,6 +163,7 @@ public: // Public members are accessible from outside the class.
      */
     void takeDamage(int damage)
     {
+        int &health = healthRef();
         health -= damage;
         if (health < 0)
             health = 0; // Ensure health does not go negative.
@@ -75,18 +177,23 @@ public: // Public members are accessible from outside the class.
 class Player : public Character
 {
 private:
-    list<string> inventory; // Player's inventory, stored as a list of strings.
+    Inventory inventory;    // Player's inventory, stored as counted stacks (ItemId -> count).
     int moves;              // Number of moves remaining for the player.
     int coins;              // Total coins collected by the player.
     int enemiesDefeated;    // Count of enemies the player has defeated.
+    EffectQueue pendingEffects; // Item effects waiting to be applied at the end of the turn.
+    uint64_t zobrist;       // Zobrist hash of moves, defense and held items, updated by every mutator.
 
 public:
     /**
      * @brief Constructor for the Player class.
-     * Initializes player with a name, default health (100), moves (10), coins (0), and enemies defeated (0).
+     * Initializes player with a name, default health (100), the starting moves of builtinRules (10), coins (0), and
+     * enemies defeated (0).
      * @param n The name of the player.
      */
-    Player(string n) : Character(n, 100), moves(10), coins(0), enemiesDefeated(0) {}
+    Player(string n)
+        : Character(n, 100), moves(builtinRules.startMoves), coins(0), enemiesDefeated(0),
+          zobrist(zobristMoves(builtinRules.startMoves) ^ zobristDefense(0)) {}
 
     /**
      * @brief Heals the player by a specified amount, up to a maximum of 100 health.
@@ -94,6 +201,7 @@ public:
      */
     void heal(int amount)
     {
+        int &health = healthRef();
         health += amount;
         if (health > 100)
             health = 100; // Ensure health does not exceed maximum.
@@ -102,15 +210,86 @@ public:
     /**
      * @brief Adds an item to the player's inventory.
      * This is a templated method, allowing it to accept various types that can be streamed to a string.
-     * @tparam T The type of the item to add (e.g., string, int, etc.).
+     * Names and IDs take the overloads below instead; this generic path is for other types (e.g., int).
+     * @tparam T The type of the item to add.
      * @param item The item to add to the inventory.
      */
     template <typename T>
     void addToInventory(const T &item)
     {
+        AllocScope scope(AllocTag::Player); // Charged to the player when allocation tracking is on.
         stringstream ss; // Use stringstream to convert any type T to a string.
         ss << item;
-        inventory.push_back(ss.str()); // Add the string representation of the item to the list.
+        addItem(itemRegistry().intern(ss.str())); // Look the name up in the item registry.
+    }
+
+    /**
+     * @brief Adds an item by name, looked up in the item registry directly (no stringstream, no copy).
+     * @param name The item's display name; unknown names are registered.
+     */
+    void addToInventory(string_view name)
+    {
+        AllocScope scope(AllocTag::Player);
+        addItem(itemRegistry().intern(name));
+    }
+
+    // Names as std::string or string literals take the string_view path rather than the generic template.
+    void addToInventory(const string &name) { addToInventory(string_view(name)); }
+    void addToInventory(const char *name) { addToInventory(string_view(name)); }
+
+    /**
+     * @brief Adds an item by ID; the same as addItem().
+     * @param item The ID of the item to add.
+     */
+    void addToInventory(ItemId item) { addItem(item); }
+
+    /**
+     * @brief Adds one item by ID. Currency is converted to coins; everything else goes onto its stack.
+     * @param item The ID of the item to add.
+     */
+    void addItem(ItemId item)
+    {
+        AllocScope scope(AllocTag::Player);
+        const ItemDef &def = itemRegistry().get(item);
+        if (def.kind == ItemKind::Currency)
+        {
+            coins += def.value; // Coins are counted once, not also kept as "5 Coins" text.
+            return;
+        }
+        pendingEffects.push(def.effect); // Applied at the end of the turn by applyPendingEffects().
+        if (def.kind != ItemKind::Consumable) // Consumables are used up on pickup; everything else is kept.
+        {
+            const uint64_t before = inventory.mask();
+            inventory.add(item);
+            zobrist ^= zobristItems(before ^ inventory.mask());
+        }
+    }
+
+    /**
+     * @brief Applies the effects of items picked up this turn (heal, damage reduction, extra moves).
+     */
+    void applyPendingEffects()
+    {
+        AllocScope scope(AllocTag::Player);
+        EffectStats stats{getHealth(), getDefense(), moves};
+        pendingEffects.applyAll(stats);
+        zobrist ^= zobristDefense(getDefense()) ^ zobristDefense(stats.defense) ^ zobristMoves(moves) ^ zobristMoves(stats.moves);
+        heal(stats.health - getHealth()); // Healing is the only way effects change health.
+        statsRef().defense = stats.defense;
+        moves = stats.moves;
+    }
+
+    /**
+     * @brief Removes one item from its stack.
+     * @param item The ID of the item to remove.
+     * @return True if the player had the item, false otherwise.
+     */
+    bool removeItem(ItemId item)
+    {
+        const uint64_t before = inventory.mask();
+        const bool removed = inventory.remove(item);
+        zobrist ^= zobristItems(before ^ inventory.mask());
+        return removed;
     }
 
     /**
@@ -119,14 +298,39 @@ public:
      */
     void addCoins(int amount) { coins += amount; }
 
+    /**
+     * @brief Overwrites the player's progress, e.g. when loading a packed snapshot.
+     * Pending effects are dropped (snapshots are taken between turns); the inventory keeps its listing order.
+     * @param health The health to set.
+     * @param defense The defense to set.
+     * @param moves The moves remaining.
+     * @param coins The coins collected.
+     * @param enemiesDefeated The enemies defeated.
+     * @param items The inventory to set.
+     */
+    void restore(int health, int defense, int moves, int coins, int enemiesDefeated, const Inventory &items)
+    {
+        healthRef() = health;
+        statsRef().defense = defense;
+        this->moves = moves;
+        this->coins = coins;
+        this->enemiesDefeated = enemiesDefeated;
+        const bool sorted = inventory.isSortedByName();
+        inventory = items;
+        if (sorted)
+            inventory.sortByName();
+        pendingEffects = EffectQueue();
+        zobrist = zobristMoves(moves) ^ zobristDefense(defense) ^ zobristItems(inventory.mask());
+    }
+
     /**
      * @brief Decrements the player's available moves by one.
-     * Moves cannot drop below 0.
+     * Moves cannot drop below 0 (GameRules::clampMoves).
      */
     void useMove()
     {
-        if (moves > 0)
-            moves--; // Only decrement if moves are available.
+        if (spendMove<GameRules::clampMoves>(moves))
+            zobrist ^= zobristMoves(moves + 1) ^ zobristMoves(moves);
     }
 
     /**
@@ -154,26 +358,23 @@ public:
 
     /**
      * @brief Gets the player's inventory.
-     * @return A list of strings representing the items in the inventory.
+     * @return A constant reference to the player's item stacks.
      */
-    list<string> getInventory() const { return inventory; }
+    const Inventory &getInventory() const { return inventory; }
+
+    /**
+     * @brief Gets the Zobrist hash of the player's part of the state.
+     * Health lives in the ECS world, so it is folded in here instead of tracked.
+     * @return The hash of health, moves, defense and held items.
+     */
+    uint64_t getZobrist() const { return zobrist ^ zobristHealth(getHealth()); }
 
     /**
      * @brief Sorts the player's inventory alphabetically (case-insensitive).
-     * Uses a lambda expression as a custom comparison predicate for std::list::sort.
+     * Stacks live in a fixed array indexed by ItemId, so this switches listings to alphabetical order
+     * (see describeInventory) instead of moving items around.
      */
-    void sortInventory()
-    {
-        // Sorts the list using a lambda for case-insensitive comparison.
-        inventory.sort([](const string &a, const string &b)
-                       {
-                           string lowerA, lowerB;
-                           // Convert strings to lowercase for comparison.
-                           transform(a.begin(), a.end(), back_inserter(lowerA), ::tolower);
-                           transform(b.begin(), b.end(), back_inserter(lowerB), ::tolower);
-                           return lowerA < lowerB; // Lexicographical comparison of lowercase strings.
-                       });
-    }
+    void sortInventory() { inventory.sortByName(); }
 
     /**
      * @brief Displays the player's basic status (name and health) to the console.
@@ -181,7 +382,7 @@ public:
      */
     void displayStatus() const override
     {
-        cout << "Player: " << name << " | Health: " << health << endl;
+        cout << "Player: " << getName() << " | Health: " << getHealth() << endl;
     }
 };
 
@@ -200,11 +401,7 @@ ostream &operator<<(ostream &os, const Player &player)
     os << "Moves Left: " << player.getMoves() << "\n";
     os << "Coins Collected: " << player.getCoins() << "\n";
     os << "Enemies Defeated: " << player.getEnemiesDefeated() << "\n";
-    os << "Inventory (Sorted): ";
-    player.getInventory(); // This call doesn't modify the internal list, it returns a copy.
-                           // The inventory is assumed to be sorted by player.sortInventory() before this is called for display.
-    for (const auto &item : player.getInventory())
-        os << item << " "; // Iterate and print each item.
+    os << "Inventory (Sorted): " << describeInventory(player.getInventory()); // Sorted by player.sortInventory() before display.
     os << "\n--------------------\n";
     return os;
 }
@@ -216,22 +413,22 @@ ostream &operator<<(ostream &os, const Player &player)
 class Enemy : public Character
 {
 private:
-    string description; // Unique description for the enemy.
+    string_view description; // Unique description for the enemy; points into builtinCampaign, so nothing is copied.
 
 public:
     /**
      * @brief Constructor for the Enemy class.
      * @param n The name of the enemy.
-     * @param desc A description of the enemy.
-     * @param hp The health points of the enemy.
+     * @param desc A description of the enemy; must outlive the enemy.
+     * @param hp The health points of the enemy; also the damage it deals when defeated.
      */
-    Enemy(string n, string desc, int hp) : Character(n, hp), description(desc) {}
+    Enemy(const string &n, string_view desc, int hp) : Character(n, hp, hp), description(desc) {}
 
     /**
      * @brief Gets the description of the enemy.
-     * @return The enemy's description.
+     * @return The enemy's description (no copy).
      */
-    string getDescription() const { return description; }
+    string_view getDescription() const { return description; }
 
     /**
      * @brief Displays the enemy's basic status (name and health required to win) to the console.
@@ -239,7 +436,7 @@ public:
      */
     void displayStatus() const override
     {
-        cout << "Enemy: " << name << " | Health Required to Win: " << health << endl;
+        cout << "Enemy: " << getName() << " | Health Required to Win: " << getHealth() << endl;
     }
 };
 
@@ -250,34 +447,34 @@ public:
 class Treasure
 {
 private:
-    string item1, item2, key; // Two items and a key composing the treasure.
+    string_view item1, item2, key; // Two items and a key composing the treasure; the text is not copied.
 
 public:
     /**
-     * @brief Constructor for the Treasure class.
+     * @brief Constructor for the Treasure class. The names must outlive the treasure.
      * @param i1 The first item in the treasure.
      * @param i2 The second item in the treasure.
      * @param k The key associated with the treasure.
      */
-    Treasure(string i1, string i2, string k) : item1(i1), item2(i2), key(k) {}
+    Treasure(string_view i1, string_view i2, string_view k) : item1(i1), item2(i2), key(k) {}
 
     /**
      * @brief Gets the first item from the treasure.
-     * @return The first item string.
+     * @return The first item string (no copy).
      */
-    string getItem1() const { return item1; }
+    string_view getItem1() const { return item1; }
 
     /**
      * @brief Gets the second item from the treasure.
-     * @return The second item string.
+     * @return The second item string (no copy).
      */
-    string getItem2() const { return item2; }
+    string_view getItem2() const { return item2; }
 
     /**
      * @brief Gets the key from the treasure.
-     * @return The key string.
+     * @return The key string (no copy).
      */
-    string getKey() const { return key; }
+    string_view getKey() const { return key; }
 };
 
 /**
@@ -287,26 +484,29 @@ public:
 class Room
 {
 private:
-    string name;       // Name of the room.
-    Enemy enemy;       // The enemy residing in this room.
-    Treasure treasure; // The treasure found in this room.
-    string challenge;  // A specific challenge for this room.
+    string_view name;      // Name of the room; like all the room's text, it points into builtinCampaign.
+    Enemy enemy;           // The enemy residing in this room.
+    Treasure treasure;     // The treasure found in this room.
+    string_view challenge; // A specific challenge for this room.
+    int timeLimit;     // Seconds to leave the room once entered (0: untimed).
 
 public:
     /**
-     * @brief Constructor for the Room class.
+     * @brief Constructor for the Room class. The text must outlive the room.
      * @param n The name of the room.
      * @param e The Enemy present in the room.
      * @param t The Treasure found in the room.
      * @param c The challenge associated with the room.
+     * @param timeLimitSeconds Seconds to leave the room once entered; 0 for no time limit.
      */
-    Room(string n, Enemy e, Treasure t, string c) : name(n), enemy(e), treasure(t), challenge(c) {}
+    Room(string_view n, Enemy e, Treasure t, string_view c, int timeLimitSeconds = 0)
+        : name(n), enemy(move(e)), treasure(t), challenge(c), timeLimit(timeLimitSeconds) {}
 
     /**
      * @brief Gets the name of the room.
-     * @return The room's name.
+     * @return The room's name (no copy).
      */
-    string getName() const { return name; }
+    string_view getName() const { return name; }
 
     /**
      * @brief Gets the enemy present in the room.
@@ -322,99 +522,46 @@ public:
 
     /**
      * @brief Gets the challenge associated with the room.
-     * @return The challenge string.
-     */
-    string getChallenge() const { return challenge; }
-};
-
-/**
- * @brief A templated manager class for storing and retrieving game assets.
- * Uses unique_ptr to manage memory for stored assets, ensuring proper deallocation.
- * @tparam T The type of asset to manage (e.g., Room, Enemy, etc.).
- */
-template <typename T>
-class GameAssetManager
-{
-private:
-    vector<unique_ptr<T>> assets; // Stores assets using smart pointers (unique ownership).
-
-public:
-    /**
-     * @brief Adds a new asset to the manager.
-     * Takes ownership of the unique_ptr.
-     * @param asset A unique_ptr to the asset to add.
+     * @return The challenge string (no copy).
      */
-    void addAsset(unique_ptr<T> asset)
-    {
-        assets.push_back(move(asset)); // Use std::move to transfer ownership of the unique_ptr.
-    }
+    string_view getChallenge() const { return challenge; }
 
     /**
-     * @brief Retrieves a constant pointer to an asset at a specific index.
-     * Throws an out_of_range exception if the index is invalid.
-     * @param index The index of the asset to retrieve.
-     * @return A constant pointer to the asset.
-     * @throws out_of_range If the index is outside the bounds of the assets vector.
+     * @brief Gets the room's time limit.
+     * @return Seconds to leave the room once entered, or 0 if the room is untimed.
      */
-    const T *getAsset(size_t index) const
-    {
-        if (index < assets.size()) // Check if the index is within valid bounds.
-        {
-            return assets[index].get(); // Return the raw pointer managed by unique_ptr.
-        }
-        // Throw an exception for invalid access.
-        throw out_of_range("Asset index out of bounds.");
-    }
-
-    /**
-     * @brief Gets the total number of assets currently managed.
-     * @return The count of assets.
-     */
-    size_t getAssetCount() const
-    {
-        return assets.size();
-    }
+    int getTimeLimit() const { return timeLimit; }
 };
 
 /**
- * @brief Represents the dungeon structure, containing multiple rooms, an enemy queue, and a room stack for navigation.
+ * @brief Represents the dungeon structure, containing multiple rooms, an enemy queue, and the player's position.
+ * The position moves by GameRules, the same rule variant the bot's simulations use.
  */
 class Dungeon
 {
 private:
     GameAssetManager<Room> roomManager; // Manages rooms using the templated asset manager.
-    queue<Enemy> enemyQueue;            // A queue to store enemies (demonstrates queue usage).
-    stack<const Room *> roomStack;      // A stack to keep track of visited rooms for backtracking.
-    int currentRoomIndex;               // The index of the current room within the roomManager.
+    queue<const Enemy *> enemyQueue;    // A queue of the rooms' enemies (demonstrates queue usage); non-owning, no copies.
+    RoomPosition position;              // The current room and the rooms left behind (for backtracking), with their hash.
+    Rng rng;                            // Seeded generator used by combat, loot and generation.
 
 public:
     /**
      * @brief Constructor for the Dungeon class.
      * Initializes the rooms and populates the enemy queue.
+     * @param generator The random stream of this game session.
      */
-    Dungeon() : currentRoomIndex(0) // Initialize currentRoomIndex to 0 for the first room.
+    Dungeon(Rng generator = Rng()) : rng(generator) // The position starts in the first room.
     {
-        // Add predefined rooms to the room manager.
-        roomManager.addAsset(make_unique<Room>("Base",
-                                               Enemy("Shadow Stalker", "A stealthy, dark creature.", 15),
-                                               Treasure("5 Coins", "Armour", "Key1"),
-                                               "Collect 5 coins"));
-        roomManager.addAsset(make_unique<Room>("Bronze",
-                                               Enemy("Viper", "A venomous menace.", 25),
-                                               Treasure("5 Coins", "Health Booster Potion", "Key2"),
-                                               "Exit the room within 5 seconds"));
-        roomManager.addAsset(make_unique<Room>("Platinum",
-                                               Enemy("Crawler", "A fast, wall-climbing creature.", 35),
-                                               Treasure("Health Booster Potion", "Armour", "Key3"),
-                                               "Defeat the enemy without armour"));
-        roomManager.addAsset(make_unique<Room>("Silver",
-                                               Enemy("Hunter", "A swift and deadly assassin.", 50),
-                                               Treasure("5 Coins", "Armour", "Key4"),
-                                               "Riddle: I have no voice, but I can teach you all I know. What am I? (Answer: book)"));
-        roomManager.addAsset(make_unique<Room>("Gold",
-                                               Enemy("Boss", "The ultimate challenge.", 70),
-                                               Treasure("5 Coins", "Health Booster Potion", "Key5"),
-                                               "Defeat the boss"));
+        AllocScope scope(AllocTag::Dungeon); // Charged to the dungeon when allocation tracking is on.
+        // Add the built-in campaign's rooms to the room manager. builtinCampaign (campaign.h) is the single source of
+        // truth for both games and the headless engine; the rooms point into its text instead of copying it.
+        roomManager.reserve(builtinCampaign.size());
+        for (const RoomDef &def : builtinCampaign)
+        {
+            roomManager.addAsset(make_unique<Room>(def.name, Enemy(string(def.enemyName), def.enemyDescription, def.enemyHealth),
+                                                   Treasure(def.item1, def.item2, def.key), def.challenge, def.timeLimitSeconds));
+        }
 
         // Populate enemy queue by iterating through managed rooms.
         for (size_t i = 0; i < roomManager.getAssetCount(); ++i)
@@ -422,132 +569,129 @@ public:
             try
             {
                 const Room *room = roomManager.getAsset(i); // Get room using the manager.
-                enemyQueue.push(room->getEnemy());          // Add the enemy to the queue.
+                enemyQueue.push(&room->getEnemy());         // Add the enemy to the queue.
             }
             catch (const out_of_range &e)
             {
                 // Catching exception if getAsset fails, though unlikely with a valid loop.
-                cerr << "Error loading enemy for room: " << e.what() << endl;
+                DUNGEON_LOG(LogLevel::Error, "enemy_load_failed", e.what());
             }
         }
     }
 
     /**
      * @brief Returns the game rules as a string.
-     * @return A string containing the game rules.
+     * @return A string containing the game rules, built once from builtinRules (no copy per frame).
      */
-    string getRules() const
+    const string &getRules() const
     {
-        return "\nWelcome to Dungeon Escape!\n\n"
-               "1. You have 10 moves to escape the dungeon.\n"
-               "2. Each room has an enemy, a treasure, and a challenge.\n"
-               "3. Defeating enemies gets you treasure.\n"
-               "4. If your health drops below 20, you lose.\n"
-               "5. Clear the final room to win.\n\n"
-               "Good luck!\n";
+        static const string rules = "\nWelcome to Dungeon Escape!\n\n"
+                                    "1. You have " + to_string(builtinRules.startMoves) + " moves to escape the dungeon.\n"
+                                    "2. Each room has an enemy, a treasure, and a challenge.\n"
+                                    "3. Defeating enemies gets you treasure.\n"
+                                    "4. If your health drops below " + to_string(builtinRules.minHealth) + ", you lose.\n"
+                                    "5. Clear the final room to win.\n"
+                                    "Press B during play to let the bot choose your moves.\n\n"
+                                    "Good luck!\n";
+        return rules;
     }
 
     /**
      * @brief Gets the current room the player is in.
-     * Uses exception handling for safe access to roomManager.
+     * Before the first room and after the last one there is no current room; that is a normal state (it holds every
+     * frame once the player has escaped), so it is answered without an exception or a log record.
      * @return A constant pointer to the current Room object, or nullptr if no room is set or an error occurs.
      */
     const Room *getCurrentRoom() const
     {
+        if (position.roomIndex >= static_cast<int>(roomManager.getAssetCount()))
+            return nullptr;
         try
         {
-            return roomManager.getAsset(currentRoomIndex); // Attempt to get the current room.
+            return roomManager.getAsset(position.roomIndex); // Attempt to get the current room.
         }
         catch (const out_of_range &e)
         {
             // Log the error but return nullptr to indicate no current room.
-            cerr << "Error getting current room: " << e.what() << endl;
+            DUNGEON_LOG(LogLevel::Error, "room_lookup_failed", e.what());
             return nullptr;
         }
     }
 
+    /**
+     * @brief Enters play: GameRules::enter() moves the player into the room where the first turn is played.
+     * @return A constant pointer to that room.
+     */
+    const Room *enter()
+    {
+        GameRules::enter(position);
+        return getCurrentRoom();
+    }
+
     /**
      * @brief Advances the player to the next room in the dungeon.
-     * Pushes the current room onto the room stack before advancing.
+     * Pushes the current room onto the history before advancing.
      * @return A constant pointer to the next Room object, or nullptr if there are no more rooms.
      */
     const Room *advanceToNextRoom()
     {
-        if (currentRoomIndex < static_cast<int>(roomManager.getAssetCount()))
-        {
-            // If currentRoomIndex is valid, push current room before advancing.
-            if (currentRoomIndex >= 0 && currentRoomIndex < static_cast<int>(roomManager.getAssetCount()))
-            {
-                try
-                {
-                    const Room *current = roomManager.getAsset(currentRoomIndex);
-                    roomStack.push(current); // Push current room onto stack for backtracking.
-                }
-                catch (const out_of_range &e)
-                {
-                    cerr << "Error pushing current room to stack (unexpected): " << e.what() << endl;
-                    return nullptr;
-                }
-            }
-
-            // Increment currentRoomIndex to point to the next room.
-            currentRoomIndex++;
-
-            // Check bounds again after incrementing to ensure the next room exists.
-            if (currentRoomIndex < static_cast<int>(roomManager.getAssetCount()))
-            {
-                try
-                {
-                    const Room *nextRoom = roomManager.getAsset(currentRoomIndex);
-                    return nextRoom; // Return the next room.
-                }
-                catch (const out_of_range &e)
-                {
-                    // Should not happen if currentRoomIndex is valid relative to getAssetCount.
-                    cerr << "Error advancing to next room (unexpected): " << e.what() << endl;
-                    return nullptr;
-                }
-            }
-        }
-        return nullptr; // No more rooms to advance to.
+        if (position.roomIndex < static_cast<int>(roomManager.getAssetCount()))
+            advanceRoom(position);
+        return getCurrentRoom();
     }
 
     /**
-     * @brief Allows the player to backtrack to the previously visited room.
-     * Pops the current room from the stack and sets the previous room as current.
+     * @brief Allows the player to backtrack to the previously visited room, as GameRules::backtrack() allows.
      * @return A constant pointer to the previous Room object, or nullptr if no previous room exists.
      */
     const Room *backtrack()
     {
-        if (roomStack.size() > 1)
-        {                               // Need at least two rooms in stack to backtrack (current + previous).
-            roomStack.pop();            // Remove current room from the stack.
-            if (!roomStack.empty())     // Check if stack is not empty after popping.
-            {
-                const Room *prevRoom = roomStack.top(); // Get the previous room from the top of the stack.
-                // Find the index of the previous room to update currentRoomIndex.
-                for (size_t i = 0; i < roomManager.getAssetCount(); ++i)
-                {
-                    try
-                    {
-                        if (roomManager.getAsset(i) == prevRoom)
-                        {
-                            currentRoomIndex = static_cast<int>(i); // Update the current room index.
-                            break;                                   // Found the room, exit loop.
-                        }
-                    }
-                    catch (const out_of_range &e)
-                    {
-                        // Log error if getAsset fails during backtrack search.
-                        cerr << "Error during backtrack room search: " << e.what() << endl;
-                    }
-                }
-                return prevRoom;
-            }
-        }
-        return nullptr; // Cannot backtrack further (stack is empty or only has one room).
+        return GameRules::backtrack(position) ? getCurrentRoom() : nullptr;
+    }
+
+    /**
+     * @brief Gets the random stream of this dungeon's game session.
+     * @return A reference to the session's generator.
+     */
+    Rng &getRng() { return rng; }
+
+    /**
+     * @brief Gets the loot table of the current room's tier, compiled with the campaign (builtinCampaignLoot).
+     * @return A constant reference to the table sampled when the room's enemy is defeated.
+     * @throws out_of_range If there is no current room.
+     */
+    const CompiledLoot &getCurrentLootTable() const { return builtinCampaignLoot.at(position.roomIndex); }
+
+    /**
+     * @brief Writes the current room and the backtracking history into a packed state.
+     * Marks the state Escaped if the player has left the last room.
+     * @param state The state to fill in.
+     */
+    void packRooms(PackedState &state) const
+    {
+        ::packRooms(position, state);
+        if (position.roomIndex >= static_cast<int>(roomManager.getAssetCount()))
+            state.setStatus(SimStatus::Escaped); // The index moves past the last room when the player escapes.
     }
 
+    /**
+     * @brief Sets the current room and the backtracking history from a packed state.
+     * @param state The state to load.
+     * @throws out_of_range If the state refers to a room this dungeon does not have.
+     */
+    void restoreRooms(const PackedState &state)
+    {
+        if (state.roomIndex() > static_cast<int>(roomManager.getAssetCount())) // One past the last room is an escaped game.
+            throw out_of_range("Packed state refers to a room outside the dungeon.");
+        unpackRooms(state, position);
+    }
+
+    /**
+     * @brief Gets the Zobrist hash of the dungeon's part of the state (current room and history).
+     * @return The hash, maintained incrementally by every move of the position.
+     */
+    uint64_t getZobrist() const { return position.roomZobrist; }
+
     /**
      * @brief Displays the final ranking and player stats to the console after the game ends.
      * @param player The Player object whose stats are to be displayed.
@@ -559,6 +703,46 @@ public:
     }
 };
 
+/**
+ * @brief Packs the player's and dungeon's state into the canonical PackedState.
+ * The status follows the GUI loop's end-of-turn checks, in the same order.
+ * @param player The player.
+ * @param dungeon The dungeon.
+ * @return The packed state.
+ * @throws out_of_range, length_error If a value is outside the packed ranges (see PackedState).
+ */
+PackedState packState(const Player &player, const Dungeon &dungeon)
+{
+    PackedState state;
+    state.setHealth(player.getHealth());
+    state.setMoves(player.getMoves());
+    state.setDefense(player.getDefense());
+    state.setCoins(player.getCoins());
+    state.setEnemiesDefeated(player.getEnemiesDefeated());
+    state.setInventory(player.getInventory().mask());
+    dungeon.packRooms(state);
+    if (state.status() == SimStatus::Escaped)
+        return state;
+    if (player.getHealth() < builtinRules.minHealth)
+        state.setStatus(SimStatus::Died);
+    else if (player.getMoves() <= 0)
+        state.setStatus(SimStatus::OutOfMoves);
+    return state;
+}
+
+/**
+ * @brief Restores the player and dungeon from a packed state (e.g. a snapshot or a replay checkpoint).
+ * @param state The packed state.
+ * @param player The player to overwrite.
+ * @param dungeon The dungeon to overwrite.
+ */
+void unpackState(const PackedState &state, Player &player, Dungeon &dungeon)
+{
+    player.restore(state.health(), state.defense(), state.moves(), state.coins(), state.enemiesDefeated(),
+                   inventoryFromMask(state.inventory()));
+    dungeon.restoreRooms(state);
+}
+
 // Enum to manage different game states for the GUI.
 enum class GameState
 {
@@ -568,6 +752,154 @@ enum class GameState
     GAME_OVER     // State for displaying game over screen.
 };
 
+/**
+ * @brief Replaces a message with prefix + name + suffix in the message's own buffer, without temporary strings.
+ * @param out The message to overwrite; once it has held the longest message, this never allocates.
+ * @param prefix Text before the name.
+ * @param name The name to insert.
+ * @param suffix Text after the name.
+ */
+void composeMessage(string &out, const char *prefix, string_view name, const char *suffix)
+{
+    out.assign(prefix);
+    out.append(name);
+    out.append(suffix);
+}
+
+// Lines of the status panel shown while playing.
+const int statusLineCount = 7;
+
+/**
+ * @brief Writes the status panel's lines (room, health, moves, enemy, description, coins, inventory) into reused
+ * buffers. Names are read through the const-reference getters, so once the buffers have grown a frame allocates
+ * nothing here.
+ * @param player The player to show.
+ * @param room The current room, or nullptr.
+ * @param lines The buffers to overwrite.
+ */
+void formatStatusLines(const Player &player, const Room *room, array<string, statusLineCount> &lines)
+{
+    const string_view none = "N/A";
+    auto text = [](string &line, const char *label, string_view value)
+    {
+        line.assign(label);
+        line.append(value);
+    };
+    auto number = [](string &line, const char *label, int value)
+    {
+        char digits[16];
+        line.assign(label);
+        line.append(digits, to_chars(digits, digits + sizeof(digits), value).ptr);
+    };
+    text(lines[0], "Room: ", room ? room->getName() : none);
+    number(lines[1], "Health: ", player.getHealth());
+    number(lines[2], "Moves Remaining: ", player.getMoves());
+    text(lines[3], "Enemy: ", room ? room->getEnemy().getName() : none);
+    text(lines[4], "Enemy Desc: ", room ? room->getEnemy().getDescription() : none);
+    number(lines[5], "Coins: ", player.getCoins());
+    lines[6].assign("Inventory: ");
+    if (player.getInventory().empty())
+        lines[6].append("Empty");
+    else
+        appendInventory(lines[6], player.getInventory()); // Stacks such as "Armour x2, Key1".
+}
+
+/**
+ * @brief Plays one turn of the game: the player's action, end-of-turn effects and the win/lose checks.
+ * Works on IDs, references and the callers' message buffers only, so after warm-up a turn makes no heap
+ * allocations (gamebench checks this over 10^6 turns).
+ * @param choice The action: 1 Fight, 2 Bypass, 3 Backtrack, 4 Quit, or 5 when a timed challenge ran out.
+ * @param player The player.
+ * @param dungeon The dungeon.
+ * @param currentRoom The room the player is in; updated when the player moves (nullptr once escaped).
+ * @param message The status message; overwritten in place.
+ * @param gameOverMessage Set when the game ends.
+ * @return PLAYING, or GAME_OVER if the game ended this turn.
+ */
+GameState playTurn(int choice, Player &player, Dungeon &dungeon, const Room *&currentRoom, string &message, string &gameOverMessage)
+{
+    GameState gameState = GameState::PLAYING;
+    player.useMove(); // Decrement a move for any action.
+    switch (choice)
+    {
+    case 1: // Fight action.
+    {
+        const Enemy &enemy = currentRoom->getEnemy();
+        // Dice-based contest: strength plus 2d6 on each side, drawn from the session's stream.
+        CombatResult result = resolveCombat(player.getCombatStats(), enemy.getCombatStats(), dungeon.getRng());
+        if (result.playerWon)
+        {
+            player.takeDamage(result.winDamage); // Cost of fighting: enemy's attack shifted by the roll margin.
+            // Two weighted drops from the room tier's loot table.
+            const CompiledLoot &loot = dungeon.getCurrentLootTable();
+            player.addItem(loot.roll(dungeon.getRng()));
+            player.addItem(loot.roll(dungeon.getRng()));
+            player.addCoins(builtinRules.winCoins);
+            player.incrementEnemiesDefeated();
+            composeMessage(message, "Victory! You defeated the ", enemy.getName(), ".");
+            currentRoom = dungeon.advanceToNextRoom(); // Move to next room.
+        }
+        else
+        {
+            player.takeDamage(builtinRules.fleeDamage); // Player takes damage for fleeing.
+            message = "Too weak! You fled and took damage.";
+        }
+    }
+    break;
+    case 2: // Bypass action.
+        player.takeDamage(builtinRules.bypassDamage); // Minor damage for bypassing.
+        message = "You bypassed the enemy, taking minor damage.";
+        currentRoom = dungeon.advanceToNextRoom(); // Move to next room.
+        break;
+    case 3: // Backtrack action.
+    {
+        const Room *previousRoom = dungeon.backtrack(); // Attempt to backtrack.
+        if (previousRoom)
+        {
+            currentRoom = previousRoom; // Update current room to previous.
+            composeMessage(message, "You backtracked to the ", currentRoom->getName(), " room.");
+        }
+        else
+        {
+            message = "No room to backtrack to!"; // Cannot backtrack message.
+        }
+    }
+    break;
+    case 4: // Quit action.
+        gameOverMessage = "You have quit the dungeon.";
+        gameState = GameState::GAME_OVER; // Change to game over state.
+        break;
+    case 5: // The room's time limit ran out: the enemy strikes and the player stays put.
+        player.takeDamage(builtinRules.timeoutDamage);
+        composeMessage(message, "Time's up! The ", currentRoom->getEnemy().getName(), " strikes while you hesitate.");
+        break;
+    }
+    player.applyPendingEffects(); // Potions, armour and hourglasses act at the end of the turn.
+
+    // Check for win/lose conditions after an action, if still in PLAYING state.
+    if (gameState == GameState::PLAYING)
+    {
+        if (!currentRoom) // No more rooms means player escaped.
+        {
+            gameOverMessage = "Congratulations! You escaped!";
+            gameState = GameState::GAME_OVER;
+        }
+        else if (player.getHealth() < builtinRules.minHealth) // Health too low.
+        {
+            gameOverMessage = "Game Over! Your health is critical.";
+            gameState = GameState::GAME_OVER;
+        }
+        else if (player.getMoves() <= 0) // No more moves.
+        {
+            gameOverMessage = "Game Over! You ran out of moves.";
+            gameState = GameState::GAME_OVER;
+        }
+    }
+    return gameState;
+}
+
+#ifndef DUNGEON_HEADLESS // Everything below needs SFML; a headless build (e.g. gamebench) stops here.
+
 /**
  * @brief Manages the Graphical User Interface (GUI) for the Dungeon Escape game.
  * Uses SFML for rendering and event handling.
@@ -581,12 +913,17 @@ private:
 
     // UI Elements (SFML Text, Shapes)
     sf::Text titleText, instructionsText, rulesTitleText, rulesBodyText, startButtonLabel;
-    sf::Text statusText[7]; // Array of sf::Text for displaying player and room status.
+    sf::Text statusText[statusLineCount]; // Array of sf::Text for displaying player and room status.
+    array<string, statusLineCount> statusLines; // This frame's status text, formatted into reused buffers.
+    array<string, statusLineCount> shownLines;  // Text currently set on statusText; only changed lines are re-set.
+    sf::Text messageText;                       // The current status message.
+    string shownRules;                          // Text currently set on rulesBodyText.
     sf::RectangleShape buttons[4];
     sf::Text buttonLabels[4];
     sf::RectangleShape startButton;
     sf::RectangleShape nameInputField, statusPanel;
     sf::Text nameInputText, namePromptText;
+    sf::Text allocationText; // Allocation overlay (toggled with F3).
 
     // Custom Colors for UI.
     sf::Color bgColor = sf::Color(30, 30, 40);           // Background color.
@@ -601,6 +938,8 @@ private:
     sf::Color messageColor = sf::Color(240, 240, 240);       // Color for status messages.
 
     string enteredName;  // Stores the player's name entered via GUI.
+    bool autoplay = false; // True while the bot chooses the player's actions (toggled with B).
+    bool showAllocations = false; // True while the allocation overlay is shown (toggled with F3).
     string statusMessage; // Stores the current message displayed in game (e.g., action results).
 
 public:
@@ -650,6 +989,12 @@ public:
      */
     string getPlayerName() const { return enteredName; }
 
+    /**
+     * @brief Checks whether the bot is playing (the player pressed B during play).
+     * @return True if autoplay is on.
+     */
+    bool isAutoplay() const { return autoplay; }
+
     /**
      * @brief Handles a single SFML event and updates game state accordingly.
      * @param event The SFML event to process.
@@ -658,8 +1003,11 @@ public:
      */
     void handleEvent(const sf::Event &event, GameState &gameState, int &choice)
     {
+        AllocScope scope(AllocTag::Gui);
         if (event.type == sf::Event::Closed)
             close(); // Close window if the close button is clicked.
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+            showAllocations = !showAllocations; // Toggle the allocation overlay on any screen.
 
         switch (gameState)
         {
@@ -701,6 +1049,8 @@ public:
                     }
                 }
             }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::B)
+                autoplay = !autoplay; // Toggle the bot.
             break;
 
         case GameState::GAME_OVER:
@@ -719,6 +1069,7 @@ public:
      */
     void update(GameState gameState, const Player &player, const Room *room, const string &message)
     {
+        AllocScope scope(AllocTag::Gui);
         if (!fontLoaded)
             return; // Don't update if font failed to load.
 
@@ -749,6 +1100,7 @@ public:
      */
     void draw(GameState gameState, const string &rules, const string &gameOverMessage, const Player &player)
     {
+        AllocScope scope(AllocTag::Gui);
         window.clear(bgColor); // Clear the window with the background color.
         if (!fontLoaded)
         {
@@ -769,7 +1121,11 @@ public:
             window.draw(nameInputText);
             break;
         case GameState::INSTRUCTIONS:
-            rulesBodyText.setString(rules); // Set rules text.
+            if (rules != shownRules) // Set rules text once, not every frame.
+            {
+                shownRules = rules;
+                rulesBodyText.setString(rules);
+            }
             window.draw(rulesTitleText);
             window.draw(rulesBodyText);
             window.draw(startButton);
@@ -779,7 +1135,7 @@ public:
             window.draw(titleText);
             window.draw(instructionsText);
             window.draw(statusPanel);
-            for (int i = 0; i < 7; ++i) // Draw all status lines.
+            for (int i = 0; i < statusLineCount; ++i) // Draw all status lines.
                 window.draw(statusText[i]);
             for (int i = 0; i < 4; ++i) // Draw all action buttons and their labels.
             {
@@ -787,20 +1143,49 @@ public:
                 window.draw(buttonLabels[i]);
             }
             if (!statusMessage.empty()) // Draw current status message if not empty.
-            {
-                sf::Text messageText(statusMessage, font, 20);
-                messageText.setFillColor(messageColor);
-                messageText.setPosition(20.f, 520.f);
                 window.draw(messageText);
-            }
             break;
         case GameState::GAME_OVER:
             drawGameOver(gameOverMessage, player); // Call helper to draw game over screen with player stats.
             break;
         }
+        if (showAllocations)
+            window.draw(allocationText); // Allocation overlay on top of every screen.
         window.display(); // Display everything drawn to the window.
     }
 
+    /**
+     * @brief Sets the numbers shown by the allocation overlay (F3): allocations and bytes per subsystem in the last
+     * frame and the last turn. Does nothing while the overlay is hidden, so its own text costs nothing then.
+     * @param frame Allocations of the last frame.
+     * @param turn Allocations of the last turn.
+     */
+    void setAllocationReport(const AllocSnapshot &frame, const AllocSnapshot &turn)
+    {
+        if (!showAllocations || !fontLoaded)
+            return;
+        AllocScope scope(AllocTag::Gui);
+        if (!allocTrackingEnabled)
+        {
+            allocationText.setString("Allocation tracking is off (build with -DDUNGEON_TRACK_ALLOCATIONS).");
+            return;
+        }
+        string text = "Allocations    frame          turn\n";
+        for (size_t t = 0; t <= allocTagCount; ++t)
+        {
+            // One line per subsystem, then the totals.
+            const AllocStats f = t < allocTagCount ? frame.tags[t] : frame.total();
+            const AllocStats n = t < allocTagCount ? turn.tags[t] : turn.total();
+            char line[96];
+            snprintf(line, sizeof(line), "%-10s %5llu / %6llu B %5llu / %6llu B\n",
+                     t < allocTagCount ? allocTagName(static_cast<AllocTag>(t)) : "total",
+                     static_cast<unsigned long long>(f.count), static_cast<unsigned long long>(f.bytes),
+                     static_cast<unsigned long long>(n.count), static_cast<unsigned long long>(n.bytes));
+            text += line;
+        }
+        allocationText.setString(text);
+    }
+
 private: // Private helper methods for GUI.
     /**
      * @brief Sets up all the UI elements, texts, buttons, etc., with their initial properties and positions.
@@ -866,7 +1251,7 @@ void GUI::setupUI()
     statusPanel.setOutlineColor({80, 80, 95});
 
     // Setup for individual status text lines.
-    for (int i = 0; i < 7; ++i)
+    for (int i = 0; i < statusLineCount; ++i)
     {
         statusText[i].setFont(font);
         statusText[i].setCharacterSize(20);
@@ -941,6 +1326,18 @@ void GUI::setupUI()
     startButtonLabel.setFillColor(textColor);
     centerOrigin(startButtonLabel);
     startButtonLabel.setPosition(startButton.getPosition()); // Position label in the center of the button.
+
+    // Status message below the action buttons.
+    messageText.setFont(font);
+    messageText.setCharacterSize(20);
+    messageText.setFillColor(messageColor);
+    messageText.setPosition(20.f, 520.f);
+
+    // Allocation overlay in the top-left corner, above everything else.
+    allocationText.setFont(font);
+    allocationText.setCharacterSize(14);
+    allocationText.setFillColor(healthWarningColor);
+    allocationText.setPosition(10.f, 5.f);
 }
 
 /**
@@ -951,31 +1348,16 @@ void GUI::setupUI()
  */
 void GUI::updateStatus(const Player &player, const Room *room, const string &message)
 {
-    // Set text for each status line using player and room data.
-    statusText[0].setString("Room: " + (room ? room->getName() : "N/A")); // Display room name, or N/A if no room.
-    statusText[1].setString("Health: " + to_string(player.getHealth()));
-    statusText[2].setString("Moves Remaining: " + to_string(player.getMoves()));
-    statusText[3].setString("Enemy: " + (room ? room->getEnemy().getName() : "N/A"));
-    statusText[4].setString("Enemy Desc: " + (room ? room->getEnemy().getDescription() : "N/A"));
-    statusText[5].setString("Coins: " + to_string(player.getCoins()));
-
-    // Build inventory string.
-    stringstream ss;
-    ss << "Inventory: ";
-    if (player.getInventory().empty())
-        ss << "Empty";
-    else
+    // Format every status line, then hand SFML only the lines that changed since the last frame.
+    formatStatusLines(player, room, statusLines);
+    for (int i = 0; i < statusLineCount; ++i)
     {
-        string invStr;
-        for (const auto &item : player.getInventory())
-            invStr += item + ", "; // Append each item with a comma and space.
-        // Remove trailing ", " if it exists to avoid an extra comma.
-        if (invStr.length() > 2)
-            ss << invStr.substr(0, invStr.length() - 2);
-        else
-            ss << invStr; // Handles cases where invStr might be empty or just " ".
+        if (statusLines[i] != shownLines[i])
+        {
+            shownLines[i] = statusLines[i];
+            statusText[i].setString(statusLines[i]);
+        }
     }
-    statusText[6].setString(ss.str()); // Set the formatted inventory string.
 
     // Change health text color based on player's health level.
     if (player.getHealth() > 50)
@@ -985,7 +1367,11 @@ void GUI::updateStatus(const Player &player, const Room *room, const string &mes
     else
         statusText[1].setFillColor(healthCriticalColor);
 
-    statusMessage = message; // Store the current message to be drawn.
+    if (message != statusMessage) // Store the current message to be drawn.
+    {
+        statusMessage = message;
+        messageText.setString(statusMessage);
+    }
 }
 
 /**
@@ -1051,20 +1437,7 @@ void GUI::drawGameOver(const string &message, const Player &player)
     if (player.getInventory().empty())
         inventorySs << "Empty";
     else
-    {
-        string invStr;
-        for (const auto &item : player.getInventory()) // Iterates through (assumed sorted) inventory.
-            invStr += item + ", ";
-        // Remove trailing ", " if it exists.
-        if (invStr.length() > 2)
-        {
-            inventorySs << invStr.substr(0, invStr.length() - 2);
-        }
-        else
-        {
-            inventorySs << invStr; // Handles cases where invStr might be empty or just " ".
-        }
-    }
+        inventorySs << describeInventory(player.getInventory()); // Sorted before the game over screen.
     sf::Text playerInventoryText(inventorySs.str(), font, 20);
     playerInventoryText.setFillColor(textColor);
     playerInventoryText.setPosition(startX, currentY);
@@ -1081,6 +1454,14 @@ void GUI::drawGameOver(const string &message, const Player &player)
     window.draw(promptText);
 }
 
+/**
+ * @brief Events the game loop schedules on its timer wheel.
+ */
+enum class GameTimer : uint8_t
+{
+    RoomChallenge, // The current room's time limit ran out.
+};
+
 /**
  * @brief The main game loop that integrates game logic with the SFML GUI.
  * Manages game states, updates game elements, and orchestrates drawing.
@@ -1094,9 +1475,28 @@ void gameLoopWithGUI(Player &player, Dungeon &dungeon, GUI &gui)
     const Room *currentRoom = nullptr;           // Pointer to the current room.
     string message = "";                         // Message displayed in the game.
     string gameOverMessage = "";                 // Message displayed on game over screen.
+    message.reserve(128);                        // Room for the longest message, so turns reuse the buffers.
+    gameOverMessage.reserve(64);
+
+    // Autoplay bot: one decision is spread over several frames, a short slice of search per frame,
+    // so the window keeps redrawing while the bot thinks. The move is made once its wall-clock budget has passed,
+    // so the pace does not depend on the frame rate.
+    const BuiltinCampaignRooms campaign;                  // The GUI dungeon is built from the built-in campaign.
+    MctsSearch<BuiltinCampaignRooms> bot(campaign);       // Reused for every decision; allocates only here.
+    const auto botMoveBudget = chrono::milliseconds(400); // Wall-clock time per move.
+    const auto botFrameSlice = chrono::milliseconds(4);   // Search time per frame.
+    chrono::steady_clock::time_point botDeadline;         // When the current decision is due.
+    bool botThinking = false;                             // True while a decision is in progress.
+    AllocWindow frameAllocations, turnAllocations;        // Shown by the F3 overlay.
+
+    // Scheduled events, advanced once per frame. A timed room's clock starts when the player enters it.
+    TimerWheel<GameTimer> timers(chrono::milliseconds(10));
+    TimerHandle challengeTimer;       // The running room clock, if any.
+    const Room *timedRoom = nullptr; // The room the clock was started for.
 
     while (gui.isOpen()) // Loop as long as the GUI window is open.
     {
+        frameAllocations.begin();
         // 1. EVENT HANDLING
         int choice = -1; // Reset choice for each loop iteration.
         sf::Event event;
@@ -1104,6 +1504,11 @@ void gameLoopWithGUI(Player &player, Dungeon &dungeon, GUI &gui)
         {
             gui.handleEvent(event, gameState, choice); // Process the event.
         }
+        // Fire the timers that are due.
+        bool challengeRanOut = false;
+        timers.advance(chrono::steady_clock::now(), [&](GameTimer timer) {
+            if (timer == GameTimer::RoomChallenge)
+                challengeRanOut = true; });
 
         // 2. GAME LOGIC UPDATES
         if (gameState == GameState::PLAYING)
@@ -1111,7 +1516,7 @@ void gameLoopWithGUI(Player &player, Dungeon &dungeon, GUI &gui)
             // First time entering PLAYING state, initialize the first room.
             if (currentRoom == nullptr)
             {
-                currentRoom = dungeon.advanceToNextRoom(); // Move to the first room.
+                currentRoom = dungeon.enter(); // Move to the room where play starts (GameRules::enter).
                 if (!currentRoom)
                 {
                     gameOverMessage = "Error: No rooms available."; // Error if no rooms.
@@ -1119,79 +1524,54 @@ void gameLoopWithGUI(Player &player, Dungeon &dungeon, GUI &gui)
                 }
                 else
                 {
-                    message = "You have entered the " + currentRoom->getName() + " room."; // Initial room message.
+                    composeMessage(message, "You have entered the ", currentRoom->getName(), " room."); // Initial room message.
                 }
             }
 
-            // Check for a player action triggered by the event handler (choice > 0).
-            if (choice > 0)
+            // A room clock that ran out plays as choice 5, unless the player clicked in the same frame.
+            if (challengeRanOut && currentRoom && choice <= 0)
+                choice = 5;
+
+            // Let the bot think for one slice; once its deadline has passed, it makes the move.
+            if (gameState == GameState::PLAYING && currentRoom && choice <= 0 && gui.isAutoplay())
             {
-                player.useMove(); // Decrement a move for any action.
-                switch (choice)
+                if (!botThinking)
                 {
-                case 1: // Fight action.
-                {
-                    const Enemy &enemy = currentRoom->getEnemy();
-                    if (player.getHealth() >= enemy.getHealth()) // Player wins if health is higher.
-                    {
-                        player.takeDamage(enemy.getHealth()); // Player takes damage equal to enemy's health (cost of fighting).
-                        player.addToInventory(currentRoom->getTreasure().getItem1());
-                        player.addToInventory(currentRoom->getTreasure().getItem2());
-                        player.addCoins(10);
-                        player.incrementEnemiesDefeated();
-                        message = "Victory! You defeated the " + enemy.getName() + ".";
-                        currentRoom = dungeon.advanceToNextRoom(); // Move to next room.
-                    }
-                    else
-                    {
-                        player.takeDamage(10);           // Player takes damage for fleeing.
-                        message = "Too weak! You fled and took damage.";
-                    }
-                }
-                break;
-                case 2: // Bypass action.
-                    player.takeDamage(5); // Minor damage for bypassing.
-                    message = "You bypassed the enemy, taking minor damage.";
-                    currentRoom = dungeon.advanceToNextRoom(); // Move to next room.
-                    break;
-                case 3: // Backtrack action.
-                {
-                    const Room *previousRoom = dungeon.backtrack(); // Attempt to backtrack.
-                    if (previousRoom)
-                    {
-                        currentRoom = previousRoom; // Update current room to previous.
-                        message = "You backtracked to the " + currentRoom->getName() + " room.";
-                    }
-                    else
-                    {
-                        message = "No room to backtrack to!"; // Cannot backtrack message.
-                    }
-                }
-                break;
-                case 4: // Quit action.
-                    gameOverMessage = "You have quit the dungeon.";
-                    gameState = GameState::GAME_OVER; // Change to game over state.
-                    break;
-                }
-                // Check for win/lose conditions after an action, if still in PLAYING state.
-                if (gameState == GameState::PLAYING)
-                {
-                    if (!currentRoom) // No more rooms means player escaped.
-                    {
-                        gameOverMessage = "Congratulations! You escaped!";
-                        gameState = GameState::GAME_OVER;
-                    }
-                    else if (player.getHealth() < 20) // Health too low.
-                    {
-                        gameOverMessage = "Game Over! Your health is critical.";
-                        gameState = GameState::GAME_OVER;
-                    }
-                    else if (player.getMoves() <= 0) // No more moves.
-                    {
-                        gameOverMessage = "Game Over! You ran out of moves.";
-                        gameState = GameState::GAME_OVER;
-                    }
+                    SimSession position;
+                    unpackState(packState(player, dungeon), position);
+                    bot.reset(position);
+                    botDeadline = chrono::steady_clock::now() + botMoveBudget;
+                    botThinking = true;
                 }
+                bot.runFor(botFrameSlice);
+                if (chrono::steady_clock::now() >= botDeadline)
+                    choice = static_cast<int>(bot.bestAction());
+            }
+
+            // Check for a player action triggered by the event handler (choice > 0).
+            if (choice > 0)
+            {
+                botThinking = false; // The next decision starts from the new position.
+                turnAllocations.begin();
+                gameState = playTurn(choice, player, dungeon, currentRoom, message, gameOverMessage);
+                turnAllocations.end();
+            }
+
+            // Entering a room restarts the clock. In a timed room it runs whenever it is not pending: after it ran
+            // out, whether that played as a turn or gave way to a click in the same frame.
+            if (currentRoom != timedRoom)
+            {
+                timers.cancel(challengeTimer);
+                timedRoom = currentRoom;
+            }
+            if (gameState == GameState::PLAYING && currentRoom && currentRoom->getTimeLimit() > 0)
+            {
+                if (!timers.pending(challengeTimer))
+                    challengeTimer = timers.scheduleIn(chrono::seconds(currentRoom->getTimeLimit()), GameTimer::RoomChallenge);
+            }
+            else
+            {
+                timers.cancel(challengeTimer);
             }
         }
 
@@ -1204,17 +1584,27 @@ void gameLoopWithGUI(Player &player, Dungeon &dungeon, GUI &gui)
         // 3. UPDATE & DRAW (GUI rendering phase)
         gui.update(gameState, player, currentRoom, message);             // Update GUI elements based on game state.
         gui.draw(gameState, dungeon.getRules(), gameOverMessage, player); // Draw everything to the window.
+        frameAllocations.end();
+        gui.setAllocationReport(frameAllocations.getLast(), turnAllocations.getLast()); // Outside the frame's count.
     }
 }
 
 /**
  * @brief Main function of the Dungeon Escape game.
  * Sets up the game and runs the main GUI game loop.
+ * @param argc Argument count.
+ * @param argv Arguments; an optional first argument is the seed to replay.
  */
-int main()
+int main(int argc, char *argv[])
 {
     cout << "Welcome to Dungeon Escape (GUI Mode)!\n"; // Initial console message.
 
+    // Every run is reproducible from its seed; pass it as the first argument to replay a game.
+    uint64_t seed = argc > 1 ? strtoull(argv[1], nullptr, 10) : freshSeed();
+    cout << "Seed: " << seed << "\n";
+
+    logger().startAsync(); // Log records reach stderr from a background thread, never from the frame loop.
+
     GUI gui; // Create GUI object.
     if (!gui.isOpen())
     {
@@ -1251,7 +1641,7 @@ int main()
     }
 
     Player player(playerName); // Create the Player object with the determined name.
-    Dungeon dungeon;           // Create the Dungeon object.
+    Dungeon dungeon(RngStreams(seed).next()); // Create the Dungeon object on the session's stream.
 
     // Start the main game loop, passing the player, dungeon, and gui objects.
     gameLoopWithGUI(player, dungeon, gui);
@@ -1262,3 +1652,4 @@ int main()
     cout << "Thanks for playing Dungeon Escape!" << endl; // Final console message.
     return 0;
 }
+#endif // DUNGEON_HEADLESS
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint> // Required for fixed-width integer types
+#include <cstddef> // Required for size_t
+#include <array>   // Required for std::array (key tables)
+
+#include "random.h"   // splitMix64 (key generation)
+#include "platform.h" // countTrailingZeros
+
+/**
+ * @brief Random keys of Zobrist hashing: one 64-bit key per (feature, value) pair.
+ * A state's hash is the XOR of the keys of its features, so a mutator updates the hash in O(1) by XOR-ing out the
+ * old value's key and XOR-ing in the new one. Hashed features are the ones future turns depend on: health, moves,
+ * defense, held item kinds, the current room and the backtracking history. Coins and enemies defeated only add up
+ * the score and are left out, so states that differ only in score share an entry.
+ */
+struct ZobristKeys
+{
+    std::array<uint64_t, 128> health{};                  // Health 0-127.
+    std::array<uint64_t, 256> moves{};                   // Moves, modulo 256.
+    std::array<uint64_t, 256> defense{};                 // Defense, modulo 256.
+    std::array<uint64_t, 64> items{};                    // One per ItemId, set while the item is held.
+    std::array<uint64_t, 16> room{};                     // Current room index.
+    std::array<std::array<uint64_t, 8>, 64> history{};   // [position in the history][room].
+};
+
+/**
+ * @brief Fills a key table from a SplitMix64 stream, at compile time.
+ * @param seed The stream's seed; a fixed seed keeps hashes stable between runs and builds.
+ * @return The keys.
+ */
+constexpr ZobristKeys makeZobristKeys(uint64_t seed)
+{
+    ZobristKeys keys{};
+    for (uint64_t &key : keys.health)
+        key = splitMix64(seed);
+    for (uint64_t &key : keys.moves)
+        key = splitMix64(seed);
+    for (uint64_t &key : keys.defense)
+        key = splitMix64(seed);
+    for (uint64_t &key : keys.items)
+        key = splitMix64(seed);
+    for (uint64_t &key : keys.room)
+        key = splitMix64(seed);
+    for (auto &position : keys.history)
+        for (uint64_t &key : position)
+            key = splitMix64(seed);
+    return keys;
+}
+
+inline constexpr ZobristKeys zobristKeys = makeZobristKeys(0x2545F4914F6CDD1DULL);
+
+constexpr uint64_t zobristHealth(int health) { return zobristKeys.health[health & 127]; }
+constexpr uint64_t zobristMoves(int moves) { return zobristKeys.moves[moves & 255]; }
+constexpr uint64_t zobristDefense(int defense) { return zobristKeys.defense[defense & 255]; }
+constexpr uint64_t zobristRoom(int room) { return zobristKeys.room[room & 15]; }
+constexpr uint64_t zobristHistory(int position, int room) { return zobristKeys.history[position & 63][room & 7]; }
+
+/**
+ * @brief Combined key of a set of held item kinds.
+ * Pass the XOR of an inventory's mask before and after a change to get the hash update for that change.
+ * @param mask Bit i set means ItemId i.
+ * @return The XOR of the keys of every set bit.
+ */
+inline uint64_t zobristItems(uint64_t mask)
+{
+    uint64_t key = 0;
+    for (; mask != 0; mask &= mask - 1)
+        key ^= zobristKeys.items[countTrailingZeros(mask)];
+    return key;
+}